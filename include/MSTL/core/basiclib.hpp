@@ -617,7 +617,7 @@ constexpr uint64_t SPACE_MASK =
 
 
 MSTL_CONST_FUNCTION MSTL_CONSTEXPR14 bool is_space(const char c) {
-	return (SPACE_MASK & (1ULL << static_cast<byte_t>(c))) != 0;
+	return static_cast<byte_t>(c) < 64 && (SPACE_MASK & (1ULL << static_cast<byte_t>(c))) != 0;
 }
 
 MSTL_CONST_FUNCTION MSTL_CONSTEXPR14 bool is_space(const wchar_t c) {
@@ -960,6 +960,7 @@ public:
     }
 
     const string& file_path() const { return path_; }
+    file_handle native_handle() const { return handle_; }
     bool opened() const { return opened_; }
     bool is_append_mode() const { return append_mode_; }
 
@@ -1,8 +1,31 @@
 #ifndef MSTL_JSON_HPP__
 #define MSTL_JSON_HPP__
 #include "map.hpp"
+#include "stack.hpp"
 #include "string.hpp"
 #include "vector.hpp"
+#include "functional.hpp"
+#include "optional.hpp"
+#include "tuple.hpp"
+// define MSTL_JSON_NO_SIMD__ to keep the scanners on the portable path.
+#if !defined(MSTL_JSON_NO_SIMD__) && defined(__AVX2__)
+#define MSTL_JSON_AVX2__ 1
+#include <immintrin.h>
+#elif !defined(MSTL_JSON_NO_SIMD__) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MSTL_JSON_SSE2__ 1
+#include <emmintrin.h>
+#endif
+#if (defined(MSTL_JSON_AVX2__) || defined(MSTL_JSON_SSE2__)) && defined(MSTL_COMPILER_MSVC__)
+#include <intrin.h>
+#endif
+#include <cmath>
+#ifdef MSTL_VERSION_17__
+#include <charconv>
+#endif
+#if defined(__cpp_lib_to_chars) && __cpp_lib_to_chars >= 201611L
+// shortest round trip floating point text comes from the standard library when it has one.
+#define MSTL_JSON_TO_CHARS__ 1
+#endif
 MSTL_BEGIN_NAMESPACE__
 
 MSTL_ERROR_BUILD_FINAL_CLASS(JsonOperateError, ValueError, "Json String Parse Failed")
@@ -132,6 +155,181 @@ public:
 };
 
 
+// bulk scanners shared by the parsers. they test 32 bytes per step with avx2 or
+// 16 with sse2, whichever the target enables at compile time, and 8 bytes per
+// step with plain integer arithmetic elsewhere.
+#if defined(MSTL_JSON_AVX2__) || defined(MSTL_JSON_SSE2__)
+inline uint32_t __json_first_bit(const uint32_t mask) noexcept {
+#ifdef MSTL_COMPILER_MSVC__
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return static_cast<uint32_t>(index);
+#else
+    return static_cast<uint32_t>(__builtin_ctz(mask));
+#endif
+}
+#endif
+
+#if defined(MSTL_JSON_AVX2__)
+constexpr size_t __JSON_SCAN_WIDTH = 32;
+
+// one bit per byte of the 32 at data that is '"' or '\\'.
+inline uint32_t __json_escape_mask(const char* data) noexcept {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    const __m256i quote = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('"'));
+    const __m256i slash = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('\\'));
+    return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(quote, slash)));
+}
+
+// one bit per byte of the 32 at data that is_space does not accept.
+inline uint32_t __json_solid_mask(const char* data) noexcept {
+    const __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+    // \t to \r are 9 to 13, shifted to 0 to 4 they survive a saturated minus 4 as zero
+    const __m256i shifted = _mm256_subs_epu8(_mm256_sub_epi8(chunk, _mm256_set1_epi8(9)), _mm256_set1_epi8(4));
+    const __m256i control = _mm256_cmpeq_epi8(shifted, _mm256_setzero_si256());
+    const __m256i blank = _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' '));
+    return ~static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_or_si256(control, blank)));
+}
+#elif defined(MSTL_JSON_SSE2__)
+constexpr size_t __JSON_SCAN_WIDTH = 16;
+
+inline uint32_t __json_escape_mask(const char* data) noexcept {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i quote = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('"'));
+    const __m128i slash = _mm_cmpeq_epi8(chunk, _mm_set1_epi8('\\'));
+    return static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(quote, slash)));
+}
+
+inline uint32_t __json_solid_mask(const char* data) noexcept {
+    const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    const __m128i shifted = _mm_subs_epu8(_mm_sub_epi8(chunk, _mm_set1_epi8(9)), _mm_set1_epi8(4));
+    const __m128i control = _mm_cmpeq_epi8(shifted, _mm_setzero_si128());
+    const __m128i blank = _mm_cmpeq_epi8(chunk, _mm_set1_epi8(' '));
+    return ~static_cast<uint32_t>(_mm_movemask_epi8(_mm_or_si128(control, blank))) & 0xFFFFu;
+}
+#else
+constexpr size_t __JSON_SCAN_WIDTH = 8;
+constexpr uint64_t __JSON_LOW_BYTES = 0x0101010101010101ULL;
+constexpr uint64_t __JSON_HIGH_BITS = 0x8080808080808080ULL;
+
+// whether any of the 8 bytes at data is '"' or '\\', a zero byte test on the xor.
+inline bool __json_has_escape(const char* data) noexcept {
+    uint64_t word;
+    memory_copy(&word, data, sizeof(word));
+    const uint64_t quote = word ^ (__JSON_LOW_BYTES * '"');
+    const uint64_t slash = word ^ (__JSON_LOW_BYTES * '\\');
+    return (((quote - __JSON_LOW_BYTES) & ~quote) | ((slash - __JSON_LOW_BYTES) & ~slash)) & __JSON_HIGH_BITS;
+}
+#endif
+
+// the first position from pos on holding '"' or '\\', length when there is none.
+inline size_t __json_scan_string(const char* data, size_t pos, const size_t length) noexcept {
+#if defined(MSTL_JSON_AVX2__) || defined(MSTL_JSON_SSE2__)
+    for (; pos + __JSON_SCAN_WIDTH <= length; pos += __JSON_SCAN_WIDTH) {
+        const uint32_t mask = __json_escape_mask(data + pos);
+        if (mask != 0) return pos + __json_first_bit(mask);
+    }
+#else
+    while (pos + __JSON_SCAN_WIDTH <= length && !__json_has_escape(data + pos)) pos += __JSON_SCAN_WIDTH;
+#endif
+    while (pos < length && data[pos] != '"' && data[pos] != '\\') ++pos;
+    return pos;
+}
+
+// the first position from pos on that is not a space, length at the end.
+inline size_t __json_skip_space(const char* data, size_t pos, const size_t length) noexcept {
+    // most values follow a single separator or none, the vector only pays for indentation
+    if (pos >= length || !_MSTL is_space(data[pos])) return pos;
+    if (++pos < length && !_MSTL is_space(data[pos])) return pos;
+#if defined(MSTL_JSON_AVX2__) || defined(MSTL_JSON_SSE2__)
+    for (; pos + __JSON_SCAN_WIDTH <= length; pos += __JSON_SCAN_WIDTH) {
+        const uint32_t mask = __json_solid_mask(data + pos);
+        if (mask != 0) return pos + __json_first_bit(mask);
+    }
+#endif
+    while (pos < length && _MSTL is_space(data[pos])) ++pos;
+    return pos;
+}
+
+inline uint32_t __json_hex4(const char* data, size_t& pos, const size_t end) {
+    if (pos + 4 > end) Exception(JsonOperateError("Invalid unicode escape"));
+    uint32_t value = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        const char c = data[pos++];
+        value <<= 4;
+        if (c >= '0' && c <= '9') value |= c - '0';
+        else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+        else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+        else Exception(JsonOperateError("Invalid unicode escape"));
+    }
+    return value;
+}
+
+inline size_t __json_put_utf8(char* out, const uint32_t code) noexcept {
+    if (code < 0x80) {
+        out[0] = static_cast<char>(code);
+        return 1;
+    }
+    if (code < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (code >> 6));
+        out[1] = static_cast<char>(0x80 | (code & 0x3F));
+        return 2;
+    }
+    if (code < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (code >> 12));
+        out[1] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (code & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (code >> 18));
+    out[1] = static_cast<char>(0x80 | ((code >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((code >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (code & 0x3F));
+    return 4;
+}
+
+// decodes the string body between pos and end into out and returns its size,
+// a decoded string is never longer than its source.
+inline size_t __json_unescape(const char* data, size_t pos, const size_t end, char* out) {
+    size_t size = 0;
+    while (pos < end) {
+        const size_t stop = _MSTL __json_scan_string(data, pos, end);
+        memory_copy(out + size, data + pos, stop - pos);
+        size += stop - pos;
+        pos = stop;
+        if (pos >= end) break;
+        if (++pos >= end) Exception(JsonOperateError("Invalid escape character"));
+        switch (data[pos++]) {
+            case '"':  out[size++] = '"'; break;
+            case '\\': out[size++] = '\\'; break;
+            case '/':  out[size++] = '/'; break;
+            case 'b':  out[size++] = '\b'; break;
+            case 'f':  out[size++] = '\f'; break;
+            case 'n':  out[size++] = '\n'; break;
+            case 'r':  out[size++] = '\r'; break;
+            case 't':  out[size++] = '\t'; break;
+            case 'u': {
+                uint32_t code = __json_hex4(data, pos, end);
+                if (code >= 0xD800 && code < 0xDC00 && pos + 6 <= end &&
+                    data[pos] == '\\' && data[pos + 1] == 'u') {
+                    pos += 2;
+                    const uint32_t low = __json_hex4(data, pos, end);
+                    if (low < 0xDC00 || low >= 0xE000) Exception(JsonOperateError("Invalid surrogate pair"));
+                    code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+                }
+                // an unpaired surrogate has no utf-8 form
+                if (code >= 0xD800 && code < 0xE000) Exception(JsonOperateError("Invalid surrogate pair"));
+                size += __json_put_utf8(out + size, code);
+                break;
+            }
+            default:
+                Exception(JsonOperateError("Invalid escape character"));
+        }
+    }
+    return size;
+}
+
+
 class json_parser {
 private:
     string json;
@@ -139,9 +337,7 @@ private:
     size_t length;
 
     void skip_space() {
-        while (pos < length && _MSTL is_space(json[pos])) {
-            pos++;
-        }
+        pos = _MSTL __json_skip_space(json.data(), pos, length);
     }
 
     char current() const {
@@ -158,29 +354,29 @@ private:
     unique_ptr<json_string> parse_string() {
         pos++;
         string result;
-        bool escaped = false;
+        const char* data = json.data();
 
         while (pos < length) {
-            const char c = json[pos++];
-            if (escaped) {
-                escaped = false;
-                switch (c) {
-                    case '"':  result += '"'; break;
-                    case '\\': result += '\\'; break;
-                    case '/':  result += '/'; break;
-                    case 'b':  result += '\b'; break;
-                    case 'f':  result += '\f'; break;
-                    case 'n':  result += '\n'; break;
-                    case 'r':  result += '\r'; break;
-                    case 't':  result += '\t'; break;
-                    default:   result += c;    break;
-                }
-            } else if (c == '"') {
-                return make_unique<json_string>(result);
-            } else if (c == '\\') {
-                escaped = true;
-            } else {
-                result += c;
+            // the run up to the next quote or backslash goes over in one copy
+            const size_t stop = _MSTL __json_scan_string(data, pos, length);
+            result.append(data + pos, stop - pos);
+            pos = stop;
+            if (pos >= length) break;
+            if (data[pos++] == '"') {
+                return make_unique<json_string>(_MSTL move(result));
+            }
+            if (pos >= length) break;
+            const char c = data[pos++];
+            switch (c) {
+                case '"':  result += '"'; break;
+                case '\\': result += '\\'; break;
+                case '/':  result += '/'; break;
+                case 'b':  result += '\b'; break;
+                case 'f':  result += '\f'; break;
+                case 'n':  result += '\n'; break;
+                case 'r':  result += '\r'; break;
+                case 't':  result += '\t'; break;
+                default:   result += c;    break;
             }
         }
         Exception(JsonOperateError("Unterminated string"));
@@ -372,6 +568,840 @@ public:
     }
 };
 
+// bump allocator of a json_document, everything is freed with it at once.
+class __json_arena {
+private:
+    static constexpr size_t BLOCK_SIZE = 64 * 1024;
+
+    vector<char*> blocks_{};
+    char* cursor_ = nullptr;
+    size_t left_ = 0;
+
+public:
+    __json_arena() = default;
+    __json_arena(const __json_arena&) = delete;
+    __json_arena& operator =(const __json_arena&) = delete;
+
+    __json_arena(__json_arena&& other) noexcept
+        : blocks_(_MSTL move(other.blocks_)), cursor_(other.cursor_), left_(other.left_) {
+        other.cursor_ = nullptr;
+        other.left_ = 0;
+    }
+    __json_arena& operator =(__json_arena&& other) noexcept {
+        if (this == &other) return *this;
+        clear();
+        blocks_ = _MSTL move(other.blocks_);
+        cursor_ = other.cursor_;
+        left_ = other.left_;
+        other.cursor_ = nullptr;
+        other.left_ = 0;
+        return *this;
+    }
+
+    ~__json_arena() { clear(); }
+
+    char* allocate(const size_t size) {
+        if (size > left_) {
+            const size_t block = _MSTL max(size, BLOCK_SIZE);
+            cursor_ = new char[block];
+            left_ = block;
+            blocks_.push_back(cursor_);
+        }
+        char* result = cursor_;
+        cursor_ += size;
+        left_ -= size;
+        return result;
+    }
+
+    void clear() noexcept {
+        for (char* block : blocks_) delete[] block;
+        blocks_.clear();
+        cursor_ = nullptr;
+        left_ = 0;
+    }
+};
+
+// one value of the tape. containers are followed by their children, object
+// members by a key node and the value's nodes, so skip leads to the next sibling.
+struct __json_node {
+    json_value::types type = json_value::Null;
+    uint32_t skip = 1;   // nodes of this subtree, itself included
+    size_t length = 0;   // bytes of a string, members or elements of a container
+    union {
+        double number = 0;
+        bool boolean;
+        const char* text;
+    };
+};
+
+class json_view;
+struct json_member;
+
+template <bool Members>
+class __json_node_iterator {
+public:
+    using iterator_category = forward_iterator_tag;
+    using value_type        = conditional_t<Members, json_member, json_view>;
+    using difference_type   = ptrdiff_t;
+    using pointer           = const value_type*;
+    using reference         = value_type;
+
+private:
+    const __json_node* node_ = nullptr;
+
+public:
+    __json_node_iterator() noexcept = default;
+    explicit __json_node_iterator(const __json_node* node) noexcept : node_(node) {}
+
+    reference operator *() const noexcept;
+
+    __json_node_iterator& operator ++() noexcept {
+        if constexpr (Members) node_ += 1 + node_[1].skip;
+        else node_ += node_->skip;
+        return *this;
+    }
+    __json_node_iterator operator ++(int) noexcept {
+        __json_node_iterator tmp = *this;
+        ++*this;
+        return tmp;
+    }
+
+    bool operator ==(const __json_node_iterator& rhs) const noexcept { return node_ == rhs.node_; }
+    bool operator !=(const __json_node_iterator& rhs) const noexcept { return node_ != rhs.node_; }
+};
+
+template <>
+json_view __json_node_iterator<false>::operator *() const noexcept;
+template <>
+json_member __json_node_iterator<true>::operator *() const noexcept;
+
+template <bool Members>
+struct __json_node_range {
+    const __json_node* first = nullptr;
+    const __json_node* last = nullptr;
+
+    __json_node_iterator<Members> begin() const noexcept { return __json_node_iterator<Members>(first); }
+    __json_node_iterator<Members> end() const noexcept { return __json_node_iterator<Members>(last); }
+};
+
+// a value inside a json_document, valid as long as the document. a default
+// constructed view stands for a missing value and tests false.
+class json_view {
+private:
+    const __json_node* node_ = nullptr;
+
+    void check(const json_value::types type) const {
+        if (node_ == nullptr || node_->type != type) {
+            Exception(JsonOperateError("Json value type mismatch"));
+        }
+    }
+
+public:
+    json_view() noexcept = default;
+    explicit json_view(const __json_node* node) noexcept : node_(node) {}
+
+    explicit operator bool() const noexcept { return node_ != nullptr; }
+
+    MSTL_NODISCARD json_value::types type() const noexcept {
+        return node_ ? node_->type : json_value::Null;
+    }
+    MSTL_NODISCARD bool is_null() const noexcept { return type() == json_value::Null; }
+    MSTL_NODISCARD bool is_bool() const noexcept { return type() == json_value::Bool; }
+    MSTL_NODISCARD bool is_number() const noexcept { return type() == json_value::Number; }
+    MSTL_NODISCARD bool is_string() const noexcept { return type() == json_value::String; }
+    MSTL_NODISCARD bool is_object() const noexcept { return type() == json_value::Object; }
+    MSTL_NODISCARD bool is_array() const noexcept { return type() == json_value::Array; }
+
+    MSTL_NODISCARD bool as_bool() const {
+        check(json_value::Bool);
+        return node_->boolean;
+    }
+    MSTL_NODISCARD double as_number() const {
+        check(json_value::Number);
+        return node_->number;
+    }
+    MSTL_NODISCARD string_view as_string() const {
+        check(json_value::String);
+        return string_view(node_->text, node_->length);
+    }
+
+    // members of an object or elements of an array, 0 for anything else.
+    MSTL_NODISCARD size_t size() const noexcept {
+        return is_object() || is_array() ? node_->length : 0;
+    }
+
+    // the index-th element, missing when out of range. O(index).
+    template <typename Int, enable_if_t<is_integral_v<Int>, int> = 0>
+    MSTL_NODISCARD json_view operator [](Int index) const {
+        check(json_value::Array);
+        if (static_cast<size_t>(index) >= node_->length) return json_view();
+        const __json_node* child = node_ + 1;
+        while (index-- > 0) child += child->skip;
+        return json_view(child);
+    }
+
+    // the first member named key, missing when there is none. a linear
+    // search in document order.
+    MSTL_NODISCARD json_view operator [](string_view key) const;
+    MSTL_NODISCARD json_view operator [](const char* key) const {
+        return (*this)[string_view(key)];
+    }
+
+    MSTL_NODISCARD __json_node_range<false> elements() const {
+        check(json_value::Array);
+        return {node_ + 1, node_ + node_->skip};
+    }
+    MSTL_NODISCARD __json_node_range<true> members() const {
+        check(json_value::Object);
+        return {node_ + 1, node_ + node_->skip};
+    }
+};
+
+struct json_member {
+    string_view key;
+    json_view value;
+};
+
+inline json_view json_view::operator [](const string_view key) const {
+    check(json_value::Object);
+    for (const json_member member : members()) {
+        if (member.key == key) return member.value;
+    }
+    return json_view();
+}
+
+template <>
+inline json_view __json_node_iterator<false>::operator *() const noexcept {
+    return json_view(node_);
+}
+template <>
+inline json_member __json_node_iterator<true>::operator *() const noexcept {
+    return {string_view(node_->text, node_->length), json_view(node_ + 1)};
+}
+
+
+// read-only DOM laid out flat: every value is one node of a single array
+// in document order and object members keep their order. strings without
+// escapes point into the source text, decoded ones live in an arena. the
+// whole document is a couple of allocations and goes away with one free.
+class json_document {
+public:
+    // containers nested deeper than this are rejected, the parser recurses per level.
+    static constexpr size_t MAX_DEPTH = 1024;
+
+private:
+    vector<__json_node> nodes_{};
+    __json_arena arena_{};
+
+    class __tape_parser {
+    private:
+        const char* json_;
+        size_t pos_ = 0;
+        size_t length_;
+        size_t depth_ = 0;
+        json_document& doc_;
+
+        char current() const noexcept {
+            return pos_ < length_ ? json_[pos_] : '\0';
+        }
+
+        void skip_space() noexcept {
+            pos_ = _MSTL __json_skip_space(json_, pos_, length_);
+        }
+
+        void expect(const char c, const char* message) {
+            if (current() != c) Exception(JsonOperateError(message));
+            ++pos_;
+        }
+
+        size_t push(const json_value::types type) {
+            __json_node node;
+            node.type = type;
+            doc_.nodes_.push_back(node);
+            return doc_.nodes_.size() - 1;
+        }
+
+        // decodes the escaped string starting at first into the arena, a
+        // decoded string is never longer than its source.
+        void decode_string(__json_node& node, const size_t first) {
+            size_t end = _MSTL __json_scan_string(json_, first, length_);
+            while (end < length_ && json_[end] == '\\') {
+                end = _MSTL __json_scan_string(json_, end + 2, length_);
+            }
+            if (end >= length_) Exception(JsonOperateError("Unterminated string"));
+
+            char* out = doc_.arena_.allocate(end - first);
+            const size_t size = _MSTL __json_unescape(json_, first, end, out);
+            pos_ = end + 1;
+            node.text = out;
+            node.length = size;
+        }
+
+        void parse_string(const json_value::types type = json_value::String) {
+            const size_t index = push(type);
+            const size_t first = ++pos_;
+            pos_ = _MSTL __json_scan_string(json_, pos_, length_);
+            if (pos_ >= length_) Exception(JsonOperateError("Unterminated string"));
+            if (json_[pos_] == '\\') {
+                decode_string(doc_.nodes_[index], first);
+                return;
+            }
+            __json_node& node = doc_.nodes_[index];
+            node.text = json_ + first;
+            node.length = pos_ - first;
+            ++pos_;
+        }
+
+        void parse_number() {
+            const size_t start = pos_;
+            const bool negative = current() == '-';
+            if (negative) ++pos_;
+            uint64_t integer = 0;
+            const size_t digits = pos_;
+            if (current() == '0') {
+                ++pos_;
+            } else if (_MSTL is_digit(current())) {
+                while (_MSTL is_digit(current())) integer = integer * 10 + (json_[pos_++] - '0');
+            } else {
+                Exception(JsonOperateError("Invalid number format"));
+            }
+            // up to 15 digits convert to a double exactly, without strtod
+            if (current() != '.' && current() != 'e' && current() != 'E' && pos_ - digits <= 15) {
+                const auto value = static_cast<double>(integer);
+                doc_.nodes_[push(json_value::Number)].number = negative ? -value : value;
+                return;
+            }
+            if (current() == '.') {
+                ++pos_;
+                if (!_MSTL is_digit(current())) Exception(JsonOperateError("Invalid decimal part"));
+                while (_MSTL is_digit(current())) ++pos_;
+            }
+            if (current() == 'e' || current() == 'E') {
+                ++pos_;
+                if (current() == '+' || current() == '-') ++pos_;
+                if (!_MSTL is_digit(current())) Exception(JsonOperateError("Invalid exponent part"));
+                while (_MSTL is_digit(current())) ++pos_;
+            }
+
+            // strtod wants a terminated string, the digits are copied to the stack
+            char buffer[128];
+            const size_t size = pos_ - start;
+            if (size >= sizeof(buffer)) Exception(JsonOperateError("Invalid number value"));
+            memory_copy(buffer, json_ + start, size);
+            buffer[size] = '\0';
+            __json_node& node = doc_.nodes_[push(json_value::Number)];
+            node.number = std::strtod(buffer, nullptr);
+        }
+
+        void parse_keyword() {
+            const auto matches = [this](const char* word, const size_t size) {
+                if (pos_ + size > length_ || memory_compare(json_ + pos_, word, size) != 0) return false;
+                pos_ += size;
+                return true;
+            };
+            if (matches("true", 4)) {
+                doc_.nodes_[push(json_value::Bool)].boolean = true;
+            } else if (matches("false", 5)) {
+                doc_.nodes_[push(json_value::Bool)].boolean = false;
+            } else if (matches("null", 4)) {
+                push(json_value::Null);
+            } else {
+                Exception(JsonOperateError("Invalid keyword"));
+            }
+        }
+
+        size_t open(const json_value::types type) {
+            if (++depth_ > MAX_DEPTH) Exception(JsonOperateError("JSON nested too deeply"));
+            return push(type);
+        }
+
+        void close(const size_t index, const size_t count) {
+            __json_node& node = doc_.nodes_[index];
+            node.length = count;
+            node.skip = static_cast<uint32_t>(doc_.nodes_.size() - index);
+            --depth_;
+        }
+
+        void parse_array() {
+            const size_t index = open(json_value::Array);
+            ++pos_;
+            skip_space();
+            size_t count = 0;
+            if (current() == ']') {
+                ++pos_;
+            } else {
+                for (;;) {
+                    parse_value();
+                    ++count;
+                    skip_space();
+                    if (current() == ']') {
+                        ++pos_;
+                        break;
+                    }
+                    expect(',', "Expected comma or closing bracket in array");
+                }
+            }
+            close(index, count);
+        }
+
+        void parse_object() {
+            const size_t index = open(json_value::Object);
+            ++pos_;
+            skip_space();
+            size_t count = 0;
+            if (current() == '}') {
+                ++pos_;
+            } else {
+                for (;;) {
+                    skip_space();
+                    if (current() != '"') Exception(JsonOperateError("Expected string key in object"));
+                    parse_string();
+                    skip_space();
+                    expect(':', "Expected colon after key in object");
+                    parse_value();
+                    ++count;
+                    skip_space();
+                    if (current() == '}') {
+                        ++pos_;
+                        break;
+                    }
+                    expect(',', "Expected comma or closing brace in object");
+                }
+            }
+            close(index, count);
+        }
+
+        void parse_value() {
+            skip_space();
+            if (pos_ >= length_) Exception(JsonOperateError("Unexpected end of input"));
+            switch (current()) {
+                case '{': parse_object(); break;
+                case '[': parse_array(); break;
+                case '"': parse_string(); break;
+                case '-':
+                case '0': case '1': case '2': case '3': case '4':
+                case '5': case '6': case '7': case '8': case '9':
+                    parse_number();
+                    break;
+                case 't': case 'f': case 'n':
+                    parse_keyword();
+                    break;
+                default:
+                    Exception(JsonOperateError("Unexpected character"));
+            }
+        }
+
+    public:
+        __tape_parser(const char* json, const size_t length, json_document& doc) noexcept
+            : json_(json), length_(length), doc_(doc) {}
+
+        void parse() {
+            // one node per eight bytes of input is plenty for most documents
+            doc_.nodes_.reserve(length_ / 8 + 1);
+            parse_value();
+            skip_space();
+            if (pos_ < length_) Exception(JsonOperateError("Unexpected characters after JSON value"));
+        }
+    };
+
+public:
+    json_document() = default;
+    json_document(const json_document&) = delete;
+    json_document& operator =(const json_document&) = delete;
+    json_document(json_document&&) noexcept = default;
+    json_document& operator =(json_document&&) noexcept = default;
+    ~json_document() = default;
+
+    // views strings of json in place, json must outlive the document.
+    static json_document parse(const string_view json) {
+        json_document doc;
+        __tape_parser(json.data(), json.size(), doc).parse();
+        return doc;
+    }
+
+    // copies json into the document first.
+    static json_document parse_copy(const string_view json) {
+        json_document doc;
+        char* text = doc.arena_.allocate(json.size() + 1);
+        memory_copy(text, json.data(), json.size());
+        text[json.size()] = '\0';
+        __tape_parser(text, json.size(), doc).parse();
+        return doc;
+    }
+
+    MSTL_NODISCARD json_view root() const noexcept {
+        return nodes_.empty() ? json_view() : json_view(nodes_.data());
+    }
+
+    // nodes on the tape, one per value and one per object key.
+    MSTL_NODISCARD size_t node_count() const noexcept {
+        return nodes_.size();
+    }
+};
+
+
+enum class JSON_TOKEN {
+    BEGIN_OBJECT,
+    END_OBJECT,
+    BEGIN_ARRAY,
+    END_ARRAY,
+    KEY,
+    STRING,
+    NUMBER,
+    BOOL,
+    NULL_VALUE,
+    END_DOCUMENT,  // a top level value is complete
+    NEED_MORE,     // every byte fed so far is used, feed more or finish
+    END_OF_INPUT   // finished and nothing is left
+};
+
+// converts a whole number token, checking it against the json grammar.
+inline double __json_to_number(const char* data, const size_t size) {
+    size_t pos = 0;
+    const bool negative = size != 0 && data[0] == '-';
+    if (negative) ++pos;
+    uint64_t integer = 0;
+    const size_t digits = pos;
+    if (pos < size && data[pos] == '0') {
+        ++pos;
+    } else if (pos < size && _MSTL is_digit(data[pos])) {
+        while (pos < size && _MSTL is_digit(data[pos])) integer = integer * 10 + (data[pos++] - '0');
+    } else {
+        Exception(JsonOperateError("Invalid number format"));
+    }
+    if (pos == size && pos - digits <= 15) {
+        const auto value = static_cast<double>(integer);
+        return negative ? -value : value;
+    }
+    if (pos < size && data[pos] == '.') {
+        ++pos;
+        if (pos >= size || !_MSTL is_digit(data[pos])) Exception(JsonOperateError("Invalid decimal part"));
+        while (pos < size && _MSTL is_digit(data[pos])) ++pos;
+    }
+    if (pos < size && (data[pos] == 'e' || data[pos] == 'E')) {
+        ++pos;
+        if (pos < size && (data[pos] == '+' || data[pos] == '-')) ++pos;
+        if (pos >= size || !_MSTL is_digit(data[pos])) Exception(JsonOperateError("Invalid exponent part"));
+        while (pos < size && _MSTL is_digit(data[pos])) ++pos;
+    }
+    if (pos != size) Exception(JsonOperateError("Invalid number format"));
+
+    char buffer[128];
+    if (size >= sizeof(buffer)) Exception(JsonOperateError("Invalid number value"));
+    memory_copy(buffer, data, size);
+    buffer[size] = '\0';
+    return std::strtod(buffer, nullptr);
+}
+
+// no-op callbacks for json_reader::parse, override the ones needed.
+class json_handler {
+public:
+    virtual ~json_handler() = default;
+
+    virtual void begin_object() {}
+    virtual void end_object() {}
+    virtual void begin_array() {}
+    virtual void end_array() {}
+    virtual void key(string_view) {}
+    virtual void string_value(string_view) {}
+    virtual void number_value(double) {}
+    virtual void bool_value(bool) {}
+    virtual void null_value() {}
+    virtual void end_document() {}
+};
+
+// resumable pull parser for input arriving in chunks. next hands out one
+// token at a time and answers NEED_MORE when the token runs past the bytes fed
+// so far. a split token stays buffered, consumed bytes are dropped on the next
+// feed, so memory is bounded by one chunk, the longest token and the depth.
+// in ndjson mode any number of documents follow each other, one per line.
+class json_reader {
+private:
+    enum class STATE { VALUE, FIRST_ELEMENT, FIRST_MEMBER, MEMBER, COLON, AFTER_VALUE, DOCUMENT_END, BETWEEN };
+
+    string buffer_{};
+    size_t pos_ = 0;
+    size_t resume_ = 0;  // bytes of a split string already scanned
+    bool escaped_ = false;
+    bool ndjson_;
+    bool finished_ = false;
+    bool newline_ = true;
+    size_t max_token_;
+    size_t documents_ = 0;
+    STATE state_;
+    vector<char> nesting_{};
+    string scratch_{};
+    string_view text_{};
+    double number_ = 0;
+    bool boolean_ = false;
+
+    static bool is_number_char(const char c) noexcept {
+        return _MSTL is_digit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E';
+    }
+
+    void skip_space() noexcept {
+        const size_t start = pos_;
+        pos_ = _MSTL __json_skip_space(buffer_.data(), pos_, buffer_.size());
+        if (state_ == STATE::BETWEEN && !newline_) {
+            for (size_t i = start; i < pos_; ++i) {
+                if (buffer_[i] == '\n') newline_ = true;
+            }
+        }
+    }
+
+    // a token that does not fit in the buffer yet.
+    JSON_TOKEN suspend(const size_t size) const {
+        if (size > max_token_) Exception(JsonOperateError("Token exceeds the reader limit"));
+        return JSON_TOKEN::NEED_MORE;
+    }
+
+    void after_value() noexcept {
+        state_ = nesting_.empty() ? STATE::DOCUMENT_END : STATE::AFTER_VALUE;
+    }
+
+    bool read_string() {
+        const char* data = buffer_.data();
+        const size_t size = buffer_.size();
+        const size_t first = pos_ + 1;
+        size_t end = first + resume_;
+        for (;;) {
+            end = _MSTL __json_scan_string(data, end, size);
+            if (end >= size) break;
+            if (data[end] == '"') {
+                if (escaped_) {
+                    scratch_.resize_and_overwrite(end - first, [data, first, end](char* out, size_t) {
+                        return _MSTL __json_unescape(data, first, end, out);
+                    });
+                    text_ = string_view(scratch_.data(), scratch_.size());
+                } else {
+                    text_ = string_view(data + first, end - first);
+                }
+                pos_ = end + 1;
+                resume_ = 0;
+                escaped_ = false;
+                return true;
+            }
+            // an escape is only skipped whole, \u with its four digits
+            const size_t width = end + 1 < size && data[end + 1] == 'u' ? 6 : 2;
+            if (end + width > size) break;
+            escaped_ = true;
+            end += width;
+        }
+        if (finished_) Exception(JsonOperateError("Unterminated string"));
+        resume_ = end - first;
+        suspend(end - pos_);
+        return false;
+    }
+
+    JSON_TOKEN read_number() {
+        const char* data = buffer_.data();
+        const size_t size = buffer_.size();
+        size_t end = pos_;
+        while (end < size && is_number_char(data[end])) ++end;
+        if (end >= size && !finished_) return suspend(end - pos_);
+        number_ = _MSTL __json_to_number(data + pos_, end - pos_);
+        text_ = string_view(data + pos_, end - pos_);
+        pos_ = end;
+        after_value();
+        return JSON_TOKEN::NUMBER;
+    }
+
+    JSON_TOKEN read_keyword() {
+        const char* data = buffer_.data();
+        const size_t size = buffer_.size();
+        size_t end = pos_;
+        while (end < size && _MSTL is_alpha(data[end])) ++end;
+        if (end >= size && !finished_) return suspend(end - pos_);
+        const string_view word(data + pos_, end - pos_);
+        JSON_TOKEN token = JSON_TOKEN::BOOL;
+        if (word == string_view("true")) {
+            boolean_ = true;
+        } else if (word == string_view("false")) {
+            boolean_ = false;
+        } else if (word == string_view("null")) {
+            token = JSON_TOKEN::NULL_VALUE;
+        } else {
+            Exception(JsonOperateError("Invalid keyword"));
+        }
+        pos_ = end;
+        after_value();
+        return token;
+    }
+
+    JSON_TOKEN read_value(const char c) {
+        switch (c) {
+            case '{':
+                ++pos_;
+                nesting_.push_back('{');
+                state_ = STATE::FIRST_MEMBER;
+                return JSON_TOKEN::BEGIN_OBJECT;
+            case '[':
+                ++pos_;
+                nesting_.push_back('[');
+                state_ = STATE::FIRST_ELEMENT;
+                return JSON_TOKEN::BEGIN_ARRAY;
+            case '"':
+                if (!read_string()) return JSON_TOKEN::NEED_MORE;
+                after_value();
+                return JSON_TOKEN::STRING;
+            case 't':
+            case 'f':
+            case 'n':
+                return read_keyword();
+            default:
+                if (c == '-' || _MSTL is_digit(c)) return read_number();
+                Exception(JsonOperateError("Unexpected character"));
+        }
+        return JSON_TOKEN::NEED_MORE;
+    }
+
+    JSON_TOKEN read_key(const char c) {
+        if (c != '"') Exception(JsonOperateError("Expected string key in object"));
+        if (!read_string()) return JSON_TOKEN::NEED_MORE;
+        state_ = STATE::COLON;
+        return JSON_TOKEN::KEY;
+    }
+
+    JSON_TOKEN close() {
+        const bool object = nesting_.back() == '{';
+        ++pos_;
+        nesting_.pop_back();
+        after_value();
+        return object ? JSON_TOKEN::END_OBJECT : JSON_TOKEN::END_ARRAY;
+    }
+
+public:
+    explicit json_reader(const bool ndjson = false, const size_t max_token = 16 * 1024 * 1024)
+        : ndjson_(ndjson), max_token_(max_token), state_(ndjson ? STATE::BETWEEN : STATE::VALUE) {}
+
+    // appends the next chunk, views handed out before are invalidated.
+    void feed(const char* data, const size_t size) {
+        Exception(!finished_, JsonOperateError("Input fed after finish"));
+        if (pos_ == buffer_.size()) {
+            buffer_.clear();
+        } else if (pos_ != 0) {
+            buffer_.erase(0, pos_);
+        }
+        pos_ = 0;
+        buffer_.append(data, size);
+    }
+
+    void feed(const string_view chunk) {
+        feed(chunk.data(), chunk.size());
+    }
+
+    // no more input follows, tokens cut by the end become errors.
+    void finish() noexcept {
+        finished_ = true;
+    }
+
+    JSON_TOKEN next() {
+        if (state_ == STATE::DOCUMENT_END) {
+            state_ = STATE::BETWEEN;
+            newline_ = false;
+            ++documents_;
+            return JSON_TOKEN::END_DOCUMENT;
+        }
+        for (;;) {
+            skip_space();
+            if (pos_ >= buffer_.size()) {
+                if (!finished_) return JSON_TOKEN::NEED_MORE;
+                if (state_ != STATE::BETWEEN) Exception(JsonOperateError("Unexpected end of input"));
+                return JSON_TOKEN::END_OF_INPUT;
+            }
+            const char c = buffer_[pos_];
+            switch (state_) {
+                case STATE::BETWEEN:
+                    if (!ndjson_) Exception(JsonOperateError("Unexpected characters after JSON value"));
+                    if (!newline_) Exception(JsonOperateError("Expected newline between documents"));
+                    state_ = STATE::VALUE;
+                    return read_value(c);
+                case STATE::FIRST_ELEMENT:
+                    if (c == ']') return close();
+                    state_ = STATE::VALUE;
+                    return read_value(c);
+                case STATE::FIRST_MEMBER:
+                    if (c == '}') return close();
+                    state_ = STATE::MEMBER;
+                    return read_key(c);
+                case STATE::MEMBER:
+                    return read_key(c);
+                case STATE::COLON:
+                    if (c != ':') Exception(JsonOperateError("Expected colon after key in object"));
+                    ++pos_;
+                    state_ = STATE::VALUE;
+                    break;
+                case STATE::AFTER_VALUE:
+                    if (c == ',') {
+                        ++pos_;
+                        state_ = nesting_.back() == '{' ? STATE::MEMBER : STATE::VALUE;
+                        break;
+                    }
+                    if (c == (nesting_.back() == '{' ? '}' : ']')) return close();
+                    Exception(JsonOperateError(nesting_.back() == '{' ?
+                        "Expected comma or closing brace in object" : "Expected comma or closing bracket in array"));
+                    break;
+                default:
+                    return read_value(c);
+            }
+        }
+    }
+
+    // pushes tokens to handler until the input fed so far is used, returns
+    // NEED_MORE or END_OF_INPUT. handler needs the members of json_handler.
+    template <typename Handler>
+    JSON_TOKEN parse(Handler& handler) {
+        for (;;) {
+            const JSON_TOKEN token = next();
+            switch (token) {
+                case JSON_TOKEN::BEGIN_OBJECT: handler.begin_object(); break;
+                case JSON_TOKEN::END_OBJECT:   handler.end_object(); break;
+                case JSON_TOKEN::BEGIN_ARRAY:  handler.begin_array(); break;
+                case JSON_TOKEN::END_ARRAY:    handler.end_array(); break;
+                case JSON_TOKEN::KEY:          handler.key(text_); break;
+                case JSON_TOKEN::STRING:       handler.string_value(text_); break;
+                case JSON_TOKEN::NUMBER:       handler.number_value(number_); break;
+                case JSON_TOKEN::BOOL:         handler.bool_value(boolean_); break;
+                case JSON_TOKEN::NULL_VALUE:   handler.null_value(); break;
+                case JSON_TOKEN::END_DOCUMENT: handler.end_document(); break;
+                default: return token;
+            }
+        }
+    }
+
+    // drives handler over the whole of source in chunks of chunk_size, any
+    // source with size_t read(string&, size_t) such as a file will do.
+    template <typename Source, typename Handler>
+    void parse(Source& source, Handler& handler, const size_t chunk_size = 64 * 1024) {
+        string chunk;
+        while (source.read(chunk, chunk_size) != 0) {
+            feed(chunk.data(), chunk.size());
+            parse(handler);
+        }
+        finish();
+        parse(handler);
+    }
+
+    // starts over with no input, keeping the buffers.
+    void reset() noexcept {
+        buffer_.clear();
+        pos_ = resume_ = 0;
+        escaped_ = finished_ = false;
+        newline_ = true;
+        documents_ = 0;
+        state_ = ndjson_ ? STATE::BETWEEN : STATE::VALUE;
+        nesting_.clear();
+    }
+
+    // the key or string of the last token, or a number as written, valid
+    // until the next call to next or feed.
+    MSTL_NODISCARD string_view text() const noexcept { return text_; }
+    MSTL_NODISCARD double number() const noexcept { return number_; }
+    MSTL_NODISCARD bool boolean() const noexcept { return boolean_; }
+    MSTL_NODISCARD size_t depth() const noexcept { return nesting_.size(); }
+    MSTL_NODISCARD size_t documents() const noexcept { return documents_; }
+};
+
 
 class json_builder {
 private:
@@ -599,91 +1629,650 @@ public:
 };
 
 
-static string json_value_to_string(const json_value* value) {
-    if (!value) {
-        return "null";
+// what follows the backslash when a byte is escaped, 'u' for \u00XX, 0 when it goes out as is.
+struct __json_escape_table {
+    char codes[256] = {};
+
+    constexpr __json_escape_table() {
+        for (int c = 0; c < 0x20; ++c) codes[c] = 'u';
+        codes[static_cast<int>('\b')] = 'b';
+        codes[static_cast<int>('\f')] = 'f';
+        codes[static_cast<int>('\n')] = 'n';
+        codes[static_cast<int>('\r')] = 'r';
+        codes[static_cast<int>('\t')] = 't';
+        codes[static_cast<int>('"')] = '"';
+        codes[static_cast<int>('\\')] = '\\';
+    }
+};
+
+// writes the decimal digits of an integer backwards from end, returns the first one.
+inline char* __json_format_integer(char* end, uint64_t magnitude, const bool negative) noexcept {
+    do {
+        *--end = static_cast<char>('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude != 0);
+    if (negative) *--end = '-';
+    return end;
+}
+
+// the shortest text that reads back as the same double, out holds 32 bytes.
+// nan and infinity have no json form and are written as null.
+inline size_t __json_format_number(char* out, const double value) {
+    if (value != value || value - value != 0) {
+        memory_copy(out, "null", 4);
+        return 4;
+    }
+    // integers below 2^53 are exact, their digits come out directly
+    if (value > -9007199254740992.0 && value < 9007199254740992.0 &&
+        value == static_cast<double>(static_cast<int64_t>(value)) && !(value == 0 && std::signbit(value))) {
+        char digits[24];
+        char* end = digits + sizeof(digits);
+        const auto integer = static_cast<int64_t>(value);
+        char* first = _MSTL __json_format_integer(end, static_cast<uint64_t>(integer < 0 ? -integer : integer), integer < 0);
+        memory_copy(out, first, end - first);
+        return end - first;
     }
-    switch (value->type()) {
-        case json_value::Null: {
-            return "null";
+#ifdef MSTL_JSON_TO_CHARS__
+    return std::to_chars(out, out + 32, value).ptr - out;
+#else
+    // fewer digits first, the first precision that reads back is the shortest one
+    for (int precision = 15; ; ++precision) {
+        const int size = std::snprintf(out, 32, "%.*g", precision, value);
+        if (precision == 17 || std::strtod(out, nullptr) == value) return static_cast<size_t>(size);
+    }
+#endif
+}
+
+// streams json text straight into one caller owned string, which keeps its
+// capacity from one document to the next, or through a chunk buffer into any
+// sink with write(const char*, size). an indent above zero pretty prints with
+// that many spaces per level.
+class json_writer {
+private:
+    struct __frame {
+        bool object = false;
+        bool filled = false;
+    };
+
+    string own_{};
+    string* out_;
+    _MSTL function<void(const char*, size_t)> sink_{};
+    size_t chunk_size_ = 0;
+    size_t indent_;
+    vector<__frame> frames_{};
+    bool after_key_ = false;
+    bool has_root_ = false;
+
+    static const __json_escape_table& escapes() noexcept {
+        static constexpr __json_escape_table table{};
+        return table;
+    }
+
+    void newline() {
+        out_->push_back('\n');
+        out_->append(frames_.size() * indent_, ' ');
+    }
+
+    // the comma and line break owed before the next element.
+    void separate() {
+        if (after_key_) {
+            after_key_ = false;
+            return;
         }
-        case json_value::Bool: {
-            const json_bool* bool_val = value->as_bool();
-            return bool_val->get_value() ? "true" : "false";
+        if (frames_.empty()) {
+            if (has_root_) Exception(JsonOperateError("Multiple root values not allowed"));
+            has_root_ = true;
+            return;
         }
-        case json_value::Number: {
-            const json_number* num_val = value->as_number();
-            const double val = num_val->get_value();
+        __frame& frame = frames_.back();
+        if (frame.object) Exception(JsonOperateError("Expected a key before the value"));
+        if (frame.filled) out_->push_back(',');
+        frame.filled = true;
+        if (indent_ != 0) newline();
+    }
 
-            if (val == static_cast<double>(static_cast<long long>(val)) &&
-                val >= static_cast<double>(INT64_MIN_SIZE) &&
-                val <= static_cast<double>(INT64_MAX_SIZE)) {
-                return _MSTL to_string(static_cast<long long>(val));
+    // runs without escapes are copied whole.
+    void write_string(const char* data, const size_t size) {
+        static constexpr char hex[] = "0123456789abcdef";
+        const char* codes = escapes().codes;
+        out_->push_back('"');
+        size_t run = 0;
+        for (size_t i = 0; i < size; ++i) {
+            const auto c = static_cast<byte_t>(data[i]);
+            const char code = codes[c];
+            if (code == 0) continue;
+            out_->append(data + run, i - run);
+            if (code == 'u') {
+                const char escape[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out_->append(escape, 6);
+            } else {
+                const char escape[2] = {'\\', code};
+                out_->append(escape, 2);
             }
-            string result = _MSTL to_string(val);
-            if (result.find('.') != string::npos) {
-                while (!result.empty() && result.back() == '0') {
-                    result.pop_back();
+            run = i + 1;
+        }
+        out_->append(data + run, size - run);
+        out_->push_back('"');
+    }
+
+    json_writer& close(const bool object) {
+        Exception(!frames_.empty() && frames_.back().object == object && !after_key_,
+            JsonOperateError("Mismatched end of container"));
+        const bool filled = frames_.back().filled;
+        frames_.pop_back();
+        if (indent_ != 0 && filled) newline();
+        out_->push_back(object ? '}' : ']');
+        return written();
+    }
+
+    json_writer& written() {
+        if (sink_ && out_->size() >= chunk_size_) flush();
+        return *this;
+    }
+
+public:
+    explicit json_writer(string& out, const size_t indent = 0)
+        : out_(&out), indent_(indent) {}
+
+    template <typename Sink>
+    explicit json_writer(Sink& sink, const size_t indent = 0, const size_t chunk_size = 16 * 1024)
+        : out_(&own_), sink_([&sink](const char* data, const size_t size) { sink.write(data, size); }),
+        chunk_size_(chunk_size), indent_(indent) {
+        own_.reserve(chunk_size + chunk_size / 2);
+    }
+
+    json_writer(const json_writer&) = delete;
+    json_writer& operator =(const json_writer&) = delete;
+
+    ~json_writer() {
+        try {
+            flush();
+        } catch (...) {}
+    }
+
+    json_writer& begin_object() {
+        separate();
+        out_->push_back('{');
+        frames_.push_back({true, false});
+        return *this;
+    }
+    json_writer& end_object() {
+        return close(true);
+    }
+
+    json_writer& begin_array() {
+        separate();
+        out_->push_back('[');
+        frames_.push_back({false, false});
+        return *this;
+    }
+    json_writer& end_array() {
+        return close(false);
+    }
+
+    json_writer& key(const string_view k) {
+        Exception(!frames_.empty() && frames_.back().object && !after_key_,
+            JsonOperateError("Key outside of an object"));
+        __frame& frame = frames_.back();
+        if (frame.filled) out_->push_back(',');
+        frame.filled = true;
+        if (indent_ != 0) newline();
+        write_string(k.data(), k.size());
+        out_->append(indent_ != 0 ? ": " : ":");
+        after_key_ = true;
+        return *this;
+    }
+    json_writer& key(const string& k) {
+        return key(string_view(k.data(), k.size()));
+    }
+    json_writer& key(const char* k) {
+        return key(string_view(k));
+    }
+
+    json_writer& value(nullptr_t) {
+        separate();
+        out_->append("null", 4);
+        return written();
+    }
+    json_writer& value(const bool v) {
+        separate();
+        if (v) out_->append("true", 4);
+        else out_->append("false", 5);
+        return written();
+    }
+    json_writer& value(const double v) {
+        separate();
+        char text[32];
+        out_->append(text, _MSTL __json_format_number(text, v));
+        return written();
+    }
+    // integers are written exactly, beyond what a double holds.
+    template <typename T, enable_if_t<is_integral<T>::value && !is_same<T, bool>::value, int> = 0>
+    json_writer& value(const T v) {
+        separate();
+        char digits[24];
+        char* end = digits + sizeof(digits);
+        const bool negative = v < 0;
+        const auto magnitude = negative ? 0 - static_cast<uint64_t>(v) : static_cast<uint64_t>(v);
+        char* first = _MSTL __json_format_integer(end, magnitude, negative);
+        out_->append(first, end - first);
+        return written();
+    }
+    json_writer& value(const string_view v) {
+        separate();
+        write_string(v.data(), v.size());
+        return written();
+    }
+    json_writer& value(const string& v) {
+        return value(string_view(v.data(), v.size()));
+    }
+    json_writer& value(const char* v) {
+        return value(string_view(v));
+    }
+
+    json_writer& write(const json_value* v) {
+        if (v == nullptr) return value(nullptr);
+        switch (v->type()) {
+            case json_value::Bool:   return value(v->as_bool()->get_value());
+            case json_value::Number: return value(v->as_number()->get_value());
+            case json_value::String: return value(v->as_string()->get_value());
+            case json_value::Array:
+                begin_array();
+                for (const auto& element : v->as_array()->get_elements()) write(element.get());
+                return end_array();
+            case json_value::Object:
+                begin_object();
+                for (const auto& member : v->as_object()->get_members()) {
+                    key(member.first);
+                    write(member.second.get());
                 }
-                if (!result.empty() && result.back() == '.') {
-                    result.pop_back();
+                return end_object();
+            default: return value(nullptr);
+        }
+    }
+
+    json_writer& write(const json_view v) {
+        switch (v.type()) {
+            case json_value::Bool:   return value(v.as_bool());
+            case json_value::Number: return value(v.as_number());
+            case json_value::String: return value(v.as_string());
+            case json_value::Array:
+                begin_array();
+                for (const json_view element : v.elements()) write(element);
+                return end_array();
+            case json_value::Object:
+                begin_object();
+                for (const json_member member : v.members()) {
+                    key(member.key);
+                    write(member.value);
                 }
-            }
-            return result;
+                return end_object();
+            default: return value(nullptr);
         }
-        case json_value::String: {
-            const json_string* str_val = value->as_string();
-            return "\"" + escape_string(str_val->get_value()) + "\"";
+    }
+
+    // hands what is buffered to the sink, nothing to do when writing into a string.
+    void flush() {
+        if (!sink_ || own_.empty()) return;
+        sink_(own_.data(), own_.size());
+        own_.clear();
+    }
+
+    // ends the document, finished or not, the next value starts a new one.
+    void reset() noexcept {
+        frames_.clear();
+        after_key_ = false;
+        has_root_ = false;
+    }
+
+    MSTL_NODISCARD size_t depth() const noexcept { return frames_.size(); }
+};
+
+
+inline string json_value_to_string(const json_value* value, const size_t indent = 0) {
+    string result;
+    json_writer(result, indent).write(value);
+    return result;
+}
+
+inline string json_to_string(const unique_ptr<json_value>& value, const size_t indent = 0) {
+    return json_value_to_string(value.get(), indent);
+}
+inline string json_to_string(const json_value* value, const size_t indent = 0) {
+    return json_value_to_string(value, indent);
+}
+inline string json_to_string(const json_view value, const size_t indent = 0) {
+    string result;
+    json_writer(result, indent).write(value);
+    return result;
+}
+
+template <typename Class, typename Member>
+struct __json_field {
+    const char* name;
+    size_t length;
+    Member Class::* member;
+};
+
+template <typename Class, typename Member, size_t N>
+constexpr __json_field<Class, Member> __make_json_field(const char (&name)[N], Member Class::* member) noexcept {
+    return {name, N - 1, member};
+}
+
+template <typename T, typename = void>
+struct __has_json_fields : false_type {};
+template <typename T>
+struct __has_json_fields<T, void_t<decltype(__mstl_json_fields(static_cast<const T*>(nullptr)))>> : true_type {};
+
+// how a type is written to json_writer and read from the tokens of json_reader,
+// specialize it for types of your own. read gets the first token of the value.
+template <typename T, typename = void>
+struct json_binder;
+
+// the next token inside a value, which has to be fed to the reader in full.
+inline JSON_TOKEN __json_next(json_reader& reader) {
+    const JSON_TOKEN token = reader.next();
+    if (token == JSON_TOKEN::NEED_MORE || token == JSON_TOKEN::END_OF_INPUT)
+        Exception(JsonOperateError("Unexpected end of input"));
+    return token;
+}
+
+// skips the value starting with token, nested containers included.
+inline void __json_skip_value(json_reader& reader, JSON_TOKEN token) {
+    size_t depth = 0;
+    for (;;) {
+        if (token == JSON_TOKEN::BEGIN_OBJECT || token == JSON_TOKEN::BEGIN_ARRAY) ++depth;
+        else if (token == JSON_TOKEN::END_OBJECT || token == JSON_TOKEN::END_ARRAY) --depth;
+        if (depth == 0) return;
+        token = __json_next(reader);
+    }
+}
+
+inline void __json_expect(const JSON_TOKEN token, const JSON_TOKEN expected, const char* message) {
+    if (token != expected) Exception(JsonOperateError(message));
+}
+
+template <>
+struct json_binder<bool> {
+    static void write(json_writer& writer, const bool v) {
+        writer.value(v);
+    }
+    static void read(json_reader& reader, const JSON_TOKEN token, bool& out) {
+        __json_expect(token, JSON_TOKEN::BOOL, "Expected a bool");
+        out = reader.boolean();
+    }
+};
+
+// integers are read from the token text, exact beyond what a double holds.
+template <typename T>
+struct json_binder<T, enable_if_t<is_integral_v<T> && !is_same_v<T, bool>>> {
+    static void write(json_writer& writer, const T v) {
+        writer.value(v);
+    }
+    static void read(json_reader& reader, const JSON_TOKEN token, T& out) {
+        using unsigned_type = make_unsigned_t<T>;
+        __json_expect(token, JSON_TOKEN::NUMBER, "Expected an integer");
+        const string_view text = reader.text();
+        const bool negative = text[0] == '-';
+        uint64_t magnitude = 0;
+        size_t pos = negative ? 1 : 0;
+        for (; pos < text.size() && _MSTL is_digit(text[pos]); ++pos) {
+            const auto digit = static_cast<uint64_t>(text[pos] - '0');
+            if (magnitude > (UINT64_MAX_SIZE - digit) / 10) Exception(JsonOperateError("Integer out of range"));
+            magnitude = magnitude * 10 + digit;
+        }
+        if (pos != text.size()) {
+            // a fraction or an exponent still names an integer when nothing is cut off
+            const double value = reader.number();
+            const double absolute = negative ? -value : value;
+            if (absolute >= 18446744073709551616.0 || absolute != static_cast<double>(static_cast<uint64_t>(absolute)))
+                Exception(JsonOperateError("Expected an integer"));
+            magnitude = static_cast<uint64_t>(absolute);
         }
-        case json_value::Array: {
-            const json_array* arr_val = value->as_array();
-            string result = "[";
+        const uint64_t max = is_signed_v<T> ? static_cast<unsigned_type>(-1) >> 1 : static_cast<unsigned_type>(-1);
+        if (negative && magnitude != 0) {
+            if (!is_signed_v<T> || magnitude - 1 > max) Exception(JsonOperateError("Integer out of range"));
+            out = static_cast<T>(static_cast<unsigned_type>(0 - magnitude));
+        } else {
+            if (magnitude > max) Exception(JsonOperateError("Integer out of range"));
+            out = static_cast<T>(magnitude);
+        }
+    }
+};
 
-            const auto& elements = arr_val->get_elements();
-            for (size_t i = 0; i < elements.size(); ++i) {
-                if (i > 0) {
-                    result += ",";
-                }
-                result += json_value_to_string(elements[i].get());
-            }
+template <typename T>
+struct json_binder<T, enable_if_t<is_floating_point_v<T>>> {
+    static void write(json_writer& writer, const T v) {
+        writer.value(static_cast<double>(v));
+    }
+    static void read(json_reader& reader, const JSON_TOKEN token, T& out) {
+        __json_expect(token, JSON_TOKEN::NUMBER, "Expected a number");
+        out = static_cast<T>(reader.number());
+    }
+};
+
+template <>
+struct json_binder<string> {
+    static void write(json_writer& writer, const string& v) {
+        writer.value(v);
+    }
+    static void read(json_reader& reader, const JSON_TOKEN token, string& out) {
+        __json_expect(token, JSON_TOKEN::STRING, "Expected a string");
+        const string_view text = reader.text();
+        out.clear();
+        out.append(text.data(), text.size());
+    }
+};
 
-            result += "]";
-            return result;
+template <typename T>
+struct json_binder<optional<T>> {
+    static void write(json_writer& writer, const optional<T>& v) {
+        if (v.has_value()) json_binder<T>::write(writer, v.value());
+        else writer.value(nullptr);
+    }
+    static void read(json_reader& reader, const JSON_TOKEN token, optional<T>& out) {
+        if (token == JSON_TOKEN::NULL_VALUE) {
+            out.reset();
+            return;
         }
-        case json_value::Object: {
-            const json_object* obj_val = value->as_object();
-            string result = "{";
+        T value{};
+        json_binder<T>::read(reader, token, value);
+        out.emplace(_MSTL move(value));
+    }
+};
 
-            const auto& members = obj_val->get_members();
-            bool first = true;
+template <typename T>
+struct json_binder<vector<T>> {
+    static void write(json_writer& writer, const vector<T>& v) {
+        writer.begin_array();
+        for (const auto& element : v) json_binder<T>::write(writer, element);
+        writer.end_array();
+    }
+    static void read(json_reader& reader, const JSON_TOKEN token, vector<T>& out) {
+        __json_expect(token, JSON_TOKEN::BEGIN_ARRAY, "Expected an array");
+        out.clear();
+        for (JSON_TOKEN next = __json_next(reader); next != JSON_TOKEN::END_ARRAY; next = __json_next(reader)) {
+            T element{};
+            json_binder<T>::read(reader, next, element);
+            out.push_back(_MSTL move(element));
+        }
+    }
+};
 
-            for (const auto& pair : members) {
-                if (!first) {
-                    result += ",";
-                }
-                first = false;
+template <typename T>
+struct json_binder<map<string, T>> {
+    static void write(json_writer& writer, const map<string, T>& v) {
+        writer.begin_object();
+        for (const auto& pair : v) {
+            writer.key(pair.first);
+            json_binder<T>::write(writer, pair.second);
+        }
+        writer.end_object();
+    }
+    static void read(json_reader& reader, const JSON_TOKEN token, map<string, T>& out) {
+        __json_expect(token, JSON_TOKEN::BEGIN_OBJECT, "Expected an object");
+        out.clear();
+        for (JSON_TOKEN next = __json_next(reader); next != JSON_TOKEN::END_OBJECT; next = __json_next(reader)) {
+            const string_view key = reader.text();
+            T& value = out[string(key.data(), key.size())];
+            json_binder<T>::read(reader, __json_next(reader), value);
+        }
+    }
+};
 
-                result += "\"" + escape_string(pair.first) + "\":";
-                result += json_value_to_string(pair.second.get());
-            }
+// types listed with MSTL_JSON_FIELDS map to objects, one member per field.
+// keys are matched against the fields without building a tree, unknown keys
+// are skipped and fields missing from the text keep their value.
+template <typename T>
+struct json_binder<T, enable_if_t<__has_json_fields<T>::value>> {
+private:
+    template <typename Class, typename Member>
+    static void write_field(json_writer& writer, const T& v, const __json_field<Class, Member>& field) {
+        writer.key(string_view(field.name, field.length));
+        json_binder<Member>::write(writer, v.*field.member);
+    }
+
+    template <typename Class, typename Member>
+    static bool read_field(json_reader& reader, const string_view key, T& out, const __json_field<Class, Member>& field) {
+        if (key.size() != field.length || memory_compare(key.data(), field.name, field.length) != 0) return false;
+        json_binder<Member>::read(reader, __json_next(reader), out.*field.member);
+        return true;
+    }
 
-            result += "}";
-            return result;
+    template <typename Fields, size_t... Index>
+    static void write_fields(json_writer& writer, const T& v, const Fields& fields, index_sequence<Index...>) {
+        (write_field(writer, v, _MSTL get<Index>(fields)), ...);
+    }
+
+    template <typename Fields, size_t... Index>
+    static bool read_fields(json_reader& reader, const string_view key, T& out,
+        const Fields& fields, index_sequence<Index...>) {
+        return (read_field(reader, key, out, _MSTL get<Index>(fields)) || ...);
+    }
+
+public:
+    static void write(json_writer& writer, const T& v) {
+        const auto fields = __mstl_json_fields(static_cast<const T*>(nullptr));
+        writer.begin_object();
+        write_fields(writer, v, fields, make_index_sequence<tuple_size_v<decltype(fields)>>{});
+        writer.end_object();
+    }
+
+    static void read(json_reader& reader, const JSON_TOKEN token, T& out) {
+        __json_expect(token, JSON_TOKEN::BEGIN_OBJECT, "Expected an object");
+        const auto fields = __mstl_json_fields(static_cast<const T*>(nullptr));
+        for (JSON_TOKEN next = __json_next(reader); next != JSON_TOKEN::END_OBJECT; next = __json_next(reader)) {
+            if (!read_fields(reader, reader.text(), out, fields, make_index_sequence<tuple_size_v<decltype(fields)>>{}))
+                __json_skip_value(reader, __json_next(reader));
         }
-        default: return "null";
     }
+};
+
+template <typename T>
+void json_write(json_writer& writer, const T& value) {
+    json_binder<T>::write(writer, value);
+}
+
+template <typename T>
+string json_serialize(const T& value, const size_t indent = 0) {
+    string result;
+    json_writer writer(result, indent);
+    json_binder<T>::write(writer, value);
+    return result;
+}
+
+// reads the next value of reader into out, the reader must hold all of it.
+template <typename T>
+void json_read(json_reader& reader, T& out) {
+    json_binder<T>::read(reader, __json_next(reader), out);
+}
+
+template <typename T>
+void json_deserialize(const string_view text, T& out) {
+    json_reader reader;
+    reader.feed(text);
+    reader.finish();
+    json_read(reader, out);
+    reader.next();
+    reader.next();
+}
+
+template <typename T>
+void json_deserialize(const string& text, T& out) {
+    json_deserialize(string_view(text.data(), text.size()), out);
+}
+
+template <typename T>
+void json_deserialize(const char* text, T& out) {
+    json_deserialize(string_view(text), out);
 }
 
-inline string json_to_string(const unique_ptr<json_value>& value) {
-    return json_value_to_string(value.get());
+template <typename T>
+T json_deserialize(const string_view text) {
+    T out{};
+    json_deserialize(text, out);
+    return out;
 }
-inline string json_to_string(unique_ptr<json_value>&& value) {
-    string result = json_value_to_string(value.get());
-    return _MSTL move(result);
+
+template <typename T>
+T json_deserialize(const string& text) {
+    return json_deserialize<T>(string_view(text.data(), text.size()));
 }
-inline string json_to_string(const json_value* value) {
-    return json_value_to_string(value);
+
+template <typename T>
+T json_deserialize(const char* text) {
+    return json_deserialize<T>(string_view(text));
 }
 
 MSTL_END_NAMESPACE__
+
+#define __MSTL_JSON_EXPAND(...) __VA_ARGS__
+#define __MSTL_JSON_CONCAT_(A, B) A##B
+#define __MSTL_JSON_CONCAT(A, B) __MSTL_JSON_CONCAT_(A, B)
+#define __MSTL_JSON_COUNT_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define __MSTL_JSON_COUNT(...) __MSTL_JSON_EXPAND(__MSTL_JSON_COUNT_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define __MSTL_JSON_FIELD(TYPE, NAME) _MSTL __make_json_field(#NAME, &TYPE::NAME)
+#define __MSTL_JSON_FIELDS_1(TYPE, NAME) __MSTL_JSON_FIELD(TYPE, NAME)
+#define __MSTL_JSON_FIELDS_2(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_1(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_3(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_2(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_4(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_3(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_5(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_4(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_6(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_5(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_7(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_6(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_8(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_7(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_9(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_8(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_10(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_9(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_11(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_10(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_12(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_11(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_13(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_12(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_14(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_13(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_15(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_14(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_16(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_15(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_17(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_16(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_18(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_17(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_19(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_18(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_20(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_19(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_21(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_20(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_22(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_21(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_23(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_22(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_24(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_23(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_25(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_24(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_26(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_25(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_27(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_26(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_28(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_27(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_29(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_28(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_30(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_29(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_31(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_30(TYPE, __VA_ARGS__))
+#define __MSTL_JSON_FIELDS_32(TYPE, NAME, ...) __MSTL_JSON_FIELD(TYPE, NAME), __MSTL_JSON_EXPAND(__MSTL_JSON_FIELDS_31(TYPE, __VA_ARGS__))
+
+// binds the listed members of TYPE to json object members of the same name.
+// put it at namespace scope next to TYPE, up to 32 members, for example
+// MSTL_JSON_FIELDS(point, x, y) makes json_serialize and json_deserialize
+// work with point.
+#define MSTL_JSON_FIELDS(TYPE, ...) \
+    inline auto __mstl_json_fields(const TYPE*) { \
+        return _MSTL make_tuple(__MSTL_JSON_EXPAND( \
+            __MSTL_JSON_CONCAT(__MSTL_JSON_FIELDS_, __MSTL_JSON_COUNT(__VA_ARGS__))(TYPE, __VA_ARGS__))); \
+    }
+
 #endif // MSTL_JSON_HPP__
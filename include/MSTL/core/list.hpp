@@ -285,7 +285,7 @@ public:
     MSTL_NODISCARD size_type size() const noexcept { return pair_.value; }
     MSTL_NODISCARD size_type max_size() const noexcept { return static_cast<size_type>(-1); }
     MSTL_NODISCARD bool empty() const noexcept {
-        return head_->next_ == head_ || link_type(head_->next_)->next_ == head_;
+        return head_->next_ == head_;
     }
 
     MSTL_NODISCARD allocator_type get_allocator() { return allocator_type(); }
@@ -1227,7 +1227,7 @@ struct __smart_ptr_counter {
         count_.fetch_add(1, std::memory_order_relaxed);
     }
     void decref() noexcept {
-        if (count_.fetch_sub(1, std::memory_order_relaxed) == 1) {
+        if (count_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
             delete this;
         }
     }
@@ -3,7 +3,9 @@
 #include "datetime.hpp"
 #ifdef MSTL_PLATFORM_LINUX__
 #include <sys/fcntl.h>
+#include <sys/random.h>
 #include <unistd.h>
+#include <cerrno>
 #endif
 MSTL_BEGIN_NAMESPACE__
 
@@ -233,7 +235,6 @@ public:
 #endif
     }
 
-private:
     static void get_random_bytes(byte_t* buffer, size_t length) {
         Exception(buffer != nullptr && length != 0, ValueError("Invalid buffer or length"));
 
@@ -251,22 +252,127 @@ private:
 
         ::CryptReleaseContext(hProv, 0);
 #elif defined(MSTL_PLATFORM_LINUX__)
-        const int fd = open("/dev/urandom", O_RDONLY);
-        Exception(fd != -1, FileOperateError("Failed to open /dev/urandom"));
+        size_t filled = 0;
+        while (filled < length) {
+            const ssize_t result = ::getrandom(buffer + filled, length - filled, 0);
+            if (result > 0) {
+                filled += static_cast<size_t>(result);
+                continue;
+            }
+            if (errno == EINTR) continue;
+            if (errno != ENOSYS) Exception(DeviceOperateError("Failed to generate random bytes"));
+            break;
+        }
+        if (filled == length) return;
 
-        ssize_t bytesRead = 0;
-        while (bytesRead < static_cast<ssize_t>(length)) {
-            const ssize_t result = ::read(fd, buffer + bytesRead, length - bytesRead);
-            if (result == -1) {
+        // kernels before 3.17 have no getrandom
+        const int fd = ::open("/dev/urandom", O_RDONLY);
+        Exception(fd != -1, FileOperateError("Failed to open /dev/urandom"));
+        while (filled < length) {
+            const ssize_t result = ::read(fd, buffer + filled, length - filled);
+            if (result <= 0) {
+                if (result == -1 && errno == EINTR) continue;
                 ::close(fd);
-                Exception(fd != -1, FileOperateError("Failed to open /dev/urandom"));
+                Exception(FileOperateError("Failed to read /dev/urandom"));
             }
-            bytesRead += result;
+            filled += static_cast<size_t>(result);
         }
         ::close(fd);
 #endif
     }
 };
 
+
+// based on ChaCha20 keystream to generate cryptographically secure random bytes.
+// every thread owns a generator keyed from the operating system, so drawing
+// never takes a lock and only costs a system call once per reseed.
+class random_chacha {
+private:
+    static constexpr size_t BLOCK_SIZE = 64;
+    static constexpr uint64_t RESEED_BLOCKS = 1ULL << 20;  // rekey after 64 MiB of output
+
+    struct __chacha_state {
+        uint32_t key[8] = {};
+        uint64_t counter = 0;
+        byte_t block[BLOCK_SIZE] = {};
+        size_t used = BLOCK_SIZE;
+        bool seeded = false;
+    };
+
+    static __chacha_state& state() {
+        static thread_local __chacha_state state;
+        return state;
+    }
+
+    static constexpr uint32_t rotate(const uint32_t x, const int n) noexcept {
+        return (x << n) | (x >> (32 - n));
+    }
+
+    static void quarter_round(uint32_t* x, const int a, const int b, const int c, const int d) noexcept {
+        x[a] += x[b]; x[d] = rotate(x[d] ^ x[a], 16);
+        x[c] += x[d]; x[b] = rotate(x[b] ^ x[c], 12);
+        x[a] += x[b]; x[d] = rotate(x[d] ^ x[a], 8);
+        x[c] += x[d]; x[b] = rotate(x[b] ^ x[c], 7);
+    }
+
+    static void reseed(__chacha_state& st) {
+        secret::get_random_bytes(reinterpret_cast<byte_t*>(st.key), sizeof(st.key));
+        st.counter = 0;
+        st.used = BLOCK_SIZE;
+        st.seeded = true;
+    }
+
+    static void refill(__chacha_state& st) {
+        if (!st.seeded || st.counter >= RESEED_BLOCKS) reseed(st);
+
+        uint32_t input[16] = {
+            0x61707865, 0x3320646e, 0x79622d32, 0x6b206574,
+            st.key[0], st.key[1], st.key[2], st.key[3],
+            st.key[4], st.key[5], st.key[6], st.key[7],
+            static_cast<uint32_t>(st.counter), static_cast<uint32_t>(st.counter >> 32), 0, 0
+        };
+        uint32_t x[16];
+        for (int i = 0; i < 16; ++i) x[i] = input[i];
+        for (int round = 0; round < 10; ++round) {
+            quarter_round(x, 0, 4, 8, 12);
+            quarter_round(x, 1, 5, 9, 13);
+            quarter_round(x, 2, 6, 10, 14);
+            quarter_round(x, 3, 7, 11, 15);
+            quarter_round(x, 0, 5, 10, 15);
+            quarter_round(x, 1, 6, 11, 12);
+            quarter_round(x, 2, 7, 8, 13);
+            quarter_round(x, 3, 4, 9, 14);
+        }
+        for (int i = 0; i < 16; ++i) {
+            const uint32_t word = x[i] + input[i];
+            st.block[i * 4] = static_cast<byte_t>(word);
+            st.block[i * 4 + 1] = static_cast<byte_t>(word >> 8);
+            st.block[i * 4 + 2] = static_cast<byte_t>(word >> 16);
+            st.block[i * 4 + 3] = static_cast<byte_t>(word >> 24);
+        }
+        ++st.counter;
+        st.used = 0;
+    }
+
+public:
+    static void fill(byte_t* buffer, size_t length) {
+        __chacha_state& st = state();
+        while (length > 0) {
+            if (st.used == BLOCK_SIZE) refill(st);
+            const size_t step = _MSTL min(length, BLOCK_SIZE - st.used);
+            _MSTL memory_copy(buffer, st.block + st.used, step);
+            st.used += step;
+            buffer += step;
+            length -= step;
+        }
+    }
+
+    static uint64_t next_uint64() {
+        uint64_t value;
+        fill(reinterpret_cast<byte_t*>(&value), sizeof(value));
+        return value;
+    }
+};
+
 MSTL_END_NAMESPACE__
 #endif // MSTL_RANDOM_HPP__
@@ -821,7 +821,10 @@ private:
     size_type size_;
 
     constexpr void range_check(const size_type n) const {
-        MSTL_DEBUG_VERIFY(size_ < n, "basic string view index out of ranges.");
+        MSTL_DEBUG_VERIFY(n < size_, "basic string view index out of ranges.");
+    }
+    constexpr void offset_check(const size_type off) const {
+        MSTL_DEBUG_VERIFY(off <= size_, "basic string view offset out of ranges.");
     }
 
     MSTL_NODISCARD constexpr size_type clamp_size(const size_type position, const size_type size) const noexcept {
@@ -891,14 +894,14 @@ public:
     }
 
     constexpr size_type copy(CharT* const str, size_type count, const size_type off = 0) const {
-        range_check(off);
+        offset_check(off);
         count = clamp_size(off, count);
         Traits::copy(str, data_ + off, count);
         return count;
     }
 
     MSTL_NODISCARD constexpr self substr(const size_type off = 0, size_type count = npos) const {
-        range_check(off);
+        offset_check(off);
         count = clamp_size(off, count);
         return self(data_ + off, count);
     }
@@ -537,8 +537,8 @@ public:
 	}
 
 	MSTL_CONSTEXPR20 void pop_back() noexcept {
-		_MSTL destroy(finish_);
 		--finish_;
+		_MSTL destroy(finish_);
 	}
 
 	MSTL_CONSTEXPR20 void assign(size_type n, const T& value) {
@@ -18,9 +18,14 @@
 #include <mutex>
 #include <thread>
 #include <condition_variable>
+#include <atomic>
+#include <chrono>
 #include "MSTL/core/queue.hpp"
 #include "MSTL/core/list.hpp"
 #include "MSTL/core/datetime.hpp"
+#include "MSTL/core/vector.hpp"
+#include "MSTL/core/unordered_map.hpp"
+#include "thread_pool.hpp"
 MSTL_BEGIN_NAMESPACE__
 
 MSTL_ERROR_BUILD_FINAL_CLASS(DatabaseError, LinkError, "Database Operations Failed.")
@@ -68,6 +73,154 @@ struct db_connect_config {
 };
 
 
+// one field of the current row, pointing into the driver's row buffer. it is
+// only valid until the result moves on, the typed readers parse the bytes in
+// place instead of going through a string.
+struct db_field {
+private:
+    string_view data_{};
+    bool null_ = true;
+
+    // the count digits at pos as a number, -1 when one of them is not a digit.
+    int32_t digits(const size_t pos, const size_t count) const noexcept {
+        if (pos + count > data_.size()) return -1;
+        int32_t value = 0;
+        for (size_t i = pos; i < pos + count; ++i) {
+            const auto digit = static_cast<uint32_t>(data_[i] - '0');
+            if (digit > 9) return -1;
+            value = value * 10 + static_cast<int32_t>(digit);
+        }
+        return value;
+    }
+
+    uint64_t magnitude(size_t pos, const uint64_t limit) const {
+        Exception(pos < data_.size(), DatabaseTypeCastError("database field is not a number"));
+        uint64_t value = 0;
+        for (; pos < data_.size(); ++pos) {
+            const auto digit = static_cast<uint64_t>(data_[pos] - '0');
+            Exception(digit <= 9, DatabaseTypeCastError("database field is not a number"));
+            Exception(value <= (limit - digit) / 10, DatabaseTypeCastError("database field out of range"));
+            value = value * 10 + digit;
+        }
+        return value;
+    }
+
+    int64_t ranged(const int64_t min, const int64_t max) const {
+        const int64_t value = as_int64();
+        Exception(value >= min && value <= max, DatabaseTypeCastError("database field out of range"));
+        return value;
+    }
+
+public:
+    db_field() noexcept = default;
+    explicit db_field(const string_view data) noexcept : data_(data), null_(data.data() == nullptr) {}
+    db_field(const char* data, const size_t size) noexcept
+        : data_(data, data ? size : 0), null_(data == nullptr) {}
+
+    MSTL_NODISCARD bool is_null() const noexcept { return null_; }
+    MSTL_NODISCARD string_view view() const noexcept { return data_; }
+    MSTL_NODISCARD const char* data() const noexcept { return data_.data(); }
+    MSTL_NODISCARD size_t size() const noexcept { return data_.size(); }
+    MSTL_NODISCARD bool empty() const noexcept { return data_.empty(); }
+
+    MSTL_NODISCARD int64_t as_int64() const {
+        if (!data_.empty() && data_[0] == '-') {
+            const uint64_t value = magnitude(1, static_cast<uint64_t>(INT64_MAX_SIZE) + 1);
+            return value == 0 ? 0 : -static_cast<int64_t>(value - 1) - 1;
+        }
+        return static_cast<int64_t>(magnitude(!data_.empty() && data_[0] == '+', INT64_MAX_SIZE));
+    }
+    MSTL_NODISCARD uint64_t as_uint64() const {
+        return magnitude(!data_.empty() && data_[0] == '+', UINT64_MAX_SIZE);
+    }
+    MSTL_NODISCARD int32_t as_int32() const {
+        return static_cast<int32_t>(ranged(INT32_MIN_SIZE, INT32_MAX_SIZE));
+    }
+    MSTL_NODISCARD int16_t as_int16() const {
+        return static_cast<int16_t>(ranged(INT16_MIN_SIZE, INT16_MAX_SIZE));
+    }
+    MSTL_NODISCARD int8_t as_int8() const {
+        return static_cast<int8_t>(ranged(INT8_MIN_SIZE, INT8_MAX_SIZE));
+    }
+    MSTL_NODISCARD bool as_bool() const { return as_int64() != 0; }
+
+    // strtod needs a terminated string, numbers are copied to the stack for it.
+    MSTL_NODISCARD float64_t as_float64() const {
+        char buffer[128];
+        Exception(data_.size() < sizeof(buffer), DatabaseTypeCastError("database field out of range"));
+        memory_copy(buffer, data_.data(), data_.size());
+        buffer[data_.size()] = '\0';
+        size_t used = 0;
+        const float64_t value = _MSTL to_float64(buffer, &used);
+        Exception(used == data_.size(), DatabaseTypeCastError("database field is not a number"));
+        return value;
+    }
+    MSTL_NODISCARD float32_t as_float32() const { return static_cast<float32_t>(as_float64()); }
+
+    MSTL_NODISCARD decimal_t as_decimal() const {
+        char buffer[128];
+        Exception(data_.size() < sizeof(buffer), DatabaseTypeCastError("database field out of range"));
+        memory_copy(buffer, data_.data(), data_.size());
+        buffer[data_.size()] = '\0';
+        size_t used = 0;
+        const decimal_t value = _MSTL to_decimal(buffer, &used);
+        Exception(used == data_.size(), DatabaseTypeCastError("database field is not a number"));
+        return value;
+    }
+
+    // big endian bytes of a BIT column.
+    MSTL_NODISCARD uint64_t as_bit() const noexcept {
+        uint64_t value = 0;
+        for (const char c : data_) value = (value << 8) | static_cast<byte_t>(c);
+        return value;
+    }
+
+    // malformed text gives the default value, like from_string.
+    MSTL_NODISCARD _MSTL date as_date() const noexcept {
+        if (data_.size() < 10 || data_[4] != '-' || data_[7] != '-') return _MSTL date{};
+        const int32_t year = digits(0, 4), month = digits(5, 2), day = digits(8, 2);
+        if (year < 0 || month < 0 || day < 0) return _MSTL date{};
+        return _MSTL date(year, month, day);
+    }
+
+    MSTL_NODISCARD _MSTL time as_time() const noexcept {
+        return time_at(0);
+    }
+
+    MSTL_NODISCARD _MSTL datetime as_datetime() const noexcept {
+        if (data_.size() < 19 || (data_[10] != ' ' && data_[10] != 'T')) return _MSTL datetime{};
+        return _MSTL datetime(as_date(), time_at(11));
+    }
+
+    MSTL_NODISCARD string as_string() const { return string(data_); }
+    MSTL_NODISCARD vector<char> as_blob() const { return {data_.data(), data_.data() + data_.size()}; }
+
+private:
+    _MSTL time time_at(const size_t pos) const noexcept {
+        if (data_.size() < pos + 8 || data_[pos + 2] != ':' || data_[pos + 5] != ':') return _MSTL time{};
+        const int32_t h = digits(pos, 2), m = digits(pos + 3, 2), s = digits(pos + 6, 2);
+        if (h < 0 || m < 0 || s < 0) return _MSTL time{};
+        return _MSTL time(h, m, s);
+    }
+};
+
+struct idb_result;
+
+// the current row of a result, a handle and not a copy of it.
+struct db_row_view {
+    using size_type = size_t;
+
+private:
+    const idb_result* result_ = nullptr;
+
+public:
+    db_row_view() noexcept = default;
+    explicit db_row_view(const idb_result* result) noexcept : result_(result) {}
+
+    MSTL_NODISCARD size_type size() const;
+    MSTL_NODISCARD db_field operator [](size_type n) const;
+};
+
 struct idb_result {
     using size_type         = size_t;
     using difference_type   = ptrdiff_t;
@@ -99,10 +252,151 @@ struct idb_result {
     virtual timestamp at_timestamp(size_type) const = 0;
     virtual string at_string(size_type) const = 0;
     virtual string_view at_enum(size_type) const = 0;
+
+    // the n-th field of the current row without converting it.
+    virtual db_field field(const size_type n) const {
+        return db_field(at(n));
+    }
+
+    MSTL_NODISCARD db_row_view row() const noexcept {
+        return db_row_view(this);
+    }
+
+    // walks the remaining rows once, calling next as it goes.
+    struct row_range {
+        struct iterator {
+            using iterator_category = input_iterator_tag;
+            using value_type        = db_row_view;
+            using difference_type   = ptrdiff_t;
+            using pointer           = const db_row_view*;
+            using reference         = db_row_view;
+
+            idb_result* result = nullptr;
+
+            reference operator *() const noexcept { return result->row(); }
+            iterator& operator ++() {
+                if (!result->next()) result = nullptr;
+                return *this;
+            }
+            bool operator ==(const iterator& rhs) const noexcept { return result == rhs.result; }
+            bool operator !=(const iterator& rhs) const noexcept { return result != rhs.result; }
+        };
+
+        idb_result* result;
+
+        iterator begin() const {
+            return iterator{result->next() ? result : nullptr};
+        }
+        iterator end() const noexcept { return iterator{}; }
+    };
+
+    MSTL_NODISCARD row_range rows() noexcept {
+        return row_range{this};
+    }
+};
+
+inline db_row_view::size_type db_row_view::size() const {
+    return result_->column_count();
+}
+
+inline db_field db_row_view::operator [](const size_type n) const {
+    return result_->field(n);
+}
+
+// a statement parsed once by the server and run many times with new
+// parameters. parameters are numbered from 0 and keep their values between
+// runs until bound again or cleared.
+struct idb_statement {
+    using size_type = size_t;
+
+    virtual ~idb_statement() = default;
+    virtual size_type param_count() const = 0;
+
+    virtual bool bind_null(size_type index) = 0;
+    virtual bool bind_int64(size_type index, int64_t value) = 0;
+    virtual bool bind_float64(size_type index, float64_t value) = 0;
+    virtual bool bind_text(size_type index, string_view value) = 0;
+    virtual bool bind_blob(size_type index, const void* data, size_type size) = 0;
+    virtual void clear_bindings() = 0;
+
+    // runs a statement without a result set.
+    virtual bool execute() = 0;
+    // the result reads from the statement and keeps it alive, run it again only after the result is gone.
+    virtual unique_ptr<idb_result> query() = 0;
+    // rows are fetched while iterating instead of all at once.
+    virtual unique_ptr<idb_result> query_stream() {
+        return query();
+    }
+    virtual uint64_t affected_rows() const = 0;
+
+    template <typename T>
+    bool bind(const size_type index, const T& value) {
+        if constexpr (is_same_v<T, nullptr_t>) {
+            return bind_null(index);
+        } else if constexpr (is_integral_v<T>) {
+            return bind_int64(index, static_cast<int64_t>(value));
+        } else if constexpr (is_floating_point_v<T>) {
+            return bind_float64(index, static_cast<float64_t>(value));
+        } else if constexpr (is_convertible_v<const T&, string_view>) {
+            return bind_text(index, string_view(value));
+        } else {
+            return bind_text(index, string_view(value.data(), value.size()));
+        }
+    }
+
+    // binds args to the parameters 0, 1, ... in order.
+    template <typename... Args>
+    bool bind_all(const Args&... args) {
+        size_type index = 0;
+        return (bind(index++, args) && ...);
+    }
+};
+
+// least recently used statements of one connection, keyed by their sql text.
+class __db_statement_cache {
+private:
+    using entry_type = pair<string, shared_ptr<idb_statement>>;
+
+    list<entry_type> entries_;  // most recently used first
+    unordered_map<string, typename list<entry_type>::iterator> index_;
+    size_t capacity_ = 64;
+
+public:
+    shared_ptr<idb_statement> find(const string& sql) {
+        auto iter = index_.find(sql);
+        if (iter == index_.end()) return nullptr;
+        entries_.splice(entries_.begin(), entries_, iter->second);
+        return iter->second->second;
+    }
+
+    void insert(const string& sql, shared_ptr<idb_statement> statement) {
+        if (capacity_ == 0) return;
+        entries_.push_front(entry_type(sql, _MSTL move(statement)));
+        index_[sql] = entries_.begin();
+        if (entries_.size() > capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+    }
+
+    void set_capacity(const size_t capacity) {
+        capacity_ = capacity;
+        while (entries_.size() > capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+    }
+
+    void clear() {
+        index_.clear();
+        entries_.clear();
+    }
+
+    MSTL_NODISCARD size_t size() const noexcept { return entries_.size(); }
 };
 
 struct idb_connect {
-    using clock_type = std::clock_t;
+    using clock_type = std::chrono::steady_clock;
 
     virtual ~idb_connect() = default;
 
@@ -118,12 +412,52 @@ struct idb_connect {
 
     virtual bool update(const _MSTL string& sql) const = 0;
     virtual unique_ptr<idb_result> query(const string& sql) const = 0;
+    // a result that fetches rows from the server one at a time instead of
+    // buffering all of them. the connection runs nothing else until it is gone.
+    virtual unique_ptr<idb_result> query_stream(const string& sql) const {
+        return query(sql);
+    }
     virtual bool connected() const = 0;
     virtual bool is_valid() const = 0;
     virtual void close() = 0;
     virtual void refresh_alive() = 0;
-    virtual clock_type get_alive() const = 0;
+    // time since the last refresh_alive, on the monotonic clock.
+    virtual clock_type::duration get_alive() const = 0;
     virtual bool reset_connect(const db_connect_config& config) = 0;
+    // clears what a borrower left behind before the pool lends the connection
+    // again, false when the session cannot be brought back to a clean state.
+    virtual bool recycle() {
+        return true;
+    }
+
+    // the statement for sql from the cache, prepared on a miss. null when
+    // the backend cannot prepare sql. statements must not outlive the connection.
+    shared_ptr<idb_statement> prepare(const string& sql) {
+        if (auto cached = statements_.find(sql)) return cached;
+        shared_ptr<idb_statement> statement = create_statement(sql);
+        if (statement) statements_.insert(sql, statement);
+        return statement;
+    }
+
+    void set_statement_cache(const size_t capacity) {
+        statements_.set_capacity(capacity);
+    }
+    MSTL_NODISCARD size_t cached_statements() const noexcept {
+        return statements_.size();
+    }
+
+protected:
+    virtual shared_ptr<idb_statement> create_statement(const string&) {
+        return nullptr;
+    }
+
+    // native statements die with the session, call before closing it.
+    void clear_statements() {
+        statements_.clear();
+    }
+
+private:
+    __db_statement_cache statements_;
 };
 
 class idb_factory {
@@ -140,20 +474,30 @@ public:
 };
 
 
+#ifdef MSTL_SUPPORT_MYSQL__
+// my_bool in MariaDB and older MySQL, bool since MySQL 8.
+using __mysql_flag = remove_pointer_t<decltype(MYSQL_BIND::is_null)>;
+
 struct db_mysql_result final : idb_result {
 private:
     MYSQL_RES* result = nullptr;
     size_type rows = 0;
     size_type columns = 0;
     MYSQL_ROW cursor = nullptr;
+    bool streaming_ = false;  // rows come from the server as next asks for them
     list<string_view>* column_name_ = new list<string_view>;
     list<enum_field_types>* column_types_ = new list<enum_field_types>;
 
-public:
-    db_mysql_result() noexcept = default;
+    // rows of a prepared statement arrive as text in these buffers
+    MYSQL_STMT* stmt_ = nullptr;
+    shared_ptr<idb_statement> statement_ = nullptr;  // keeps stmt_ from being closed under the result
+    vector<MYSQL_BIND> binds_{};
+    vector<vector<char>> buffers_{};
+    vector<unsigned long> lengths_{};
+    vector<__mysql_flag> nulls_{};
+    vector<char*> row_{};
 
-    explicit db_mysql_result(MYSQL_RES* result) noexcept
-        : result(result), rows(mysql_num_rows(result)), columns(mysql_num_fields(result)) {
+    void read_fields() {
         MYSQL_FIELD* field;
         while ((field = mysql_fetch_field(result))) {
             column_name_->push_back(field->name);
@@ -161,15 +505,91 @@ public:
         }
     }
 
+    void bind_buffer(const size_type n) {
+        binds_[n].buffer = buffers_[n].data();
+        binds_[n].buffer_length = buffers_[n].size();
+    }
+
+    bool fetch_statement() {
+        const int status = mysql_stmt_fetch(stmt_);
+        if (status == 1 || status == MYSQL_NO_DATA) return false;
+        bool grown = false;
+        for (size_type n = 0; n < columns; ++n) {
+            if (nulls_[n]) {
+                row_[n] = nullptr;
+                continue;
+            }
+            if (lengths_[n] >= buffers_[n].size()) {
+                // truncated, fetch the column again into a buffer that fits
+                buffers_[n].resize(lengths_[n] + 1);
+                bind_buffer(n);
+                mysql_stmt_fetch_column(stmt_, &binds_[n], static_cast<unsigned int>(n), 0);
+                grown = true;
+            }
+            buffers_[n][lengths_[n]] = '\0';
+            row_[n] = buffers_[n].data();
+        }
+        if (grown) mysql_stmt_bind_result(stmt_, binds_.data());
+        return true;
+    }
+
+    unsigned long field_length(const size_type n) const {
+        return stmt_ ? lengths_[n] : mysql_fetch_lengths(result)[n];
+    }
+
+public:
+    db_mysql_result() noexcept = default;
+
+    // result of mysql_store_result, or of mysql_use_result when streaming.
+    explicit db_mysql_result(MYSQL_RES* result, const bool streaming = false) noexcept
+        : result(result), streaming_(streaming) {
+        if (result == nullptr) return;
+        rows = streaming_ ? 0 : mysql_num_rows(result);
+        columns = mysql_num_fields(result);
+        read_fields();
+    }
+
+    // result set of an executed statement, empty when it has none.
+    db_mysql_result(MYSQL_STMT* stmt, shared_ptr<idb_statement> statement, const bool streaming = false)
+        : result(mysql_stmt_result_metadata(stmt)), streaming_(streaming) {
+        if (result == nullptr) return;
+        stmt_ = stmt;
+        statement_ = _MSTL move(statement);
+        columns = mysql_num_fields(result);
+        read_fields();
+        if (!streaming_) {
+            mysql_stmt_store_result(stmt_);
+            rows = mysql_stmt_num_rows(stmt_);
+        }
+
+        binds_.resize(columns);
+        buffers_.resize(columns, vector<char>(64));
+        lengths_.resize(columns);
+        nulls_.resize(columns);
+        row_.resize(columns);
+        memory_set(binds_.data(), 0, sizeof(MYSQL_BIND) * columns);
+        for (size_type n = 0; n < columns; ++n) {
+            binds_[n].buffer_type = MYSQL_TYPE_STRING;
+            binds_[n].length = &lengths_[n];
+            binds_[n].is_null = &nulls_[n];
+            bind_buffer(n);
+        }
+        mysql_stmt_bind_result(stmt_, binds_.data());
+    }
+
+    // a streamed result reads what is left of its rows before going away.
     ~db_mysql_result() override {
-        mysql_free_result(result);
+        if (stmt_) mysql_stmt_free_result(stmt_);
+        if (result) mysql_free_result(result);
         delete column_name_;
         delete column_types_;
     }
 
     MSTL_NODISCARD bool empty() const noexcept override { return result == nullptr; }
 
+    // rows fetched so far while streaming.
     MSTL_NODISCARD size_type row_count() const noexcept override { return rows; }
+    MSTL_NODISCARD bool streaming() const noexcept { return streaming_; }
     MSTL_NODISCARD size_type column_count() const noexcept override { return columns; }
 
     MSTL_NODISCARD const list<string_view>& column_names() const noexcept override {
@@ -180,17 +600,24 @@ public:
     }
 
     MSTL_NODISCARD bool next() noexcept override {
-        if (!empty()) {
+        if (empty()) return false;
+        if (stmt_) {
+            cursor = fetch_statement() ? row_.data() : nullptr;
+        } else {
             cursor = mysql_fetch_row(result);
-            return cursor != nullptr;
         }
-        return false;
+        if (streaming_ && cursor) ++rows;
+        return cursor != nullptr;
     }
 
     MSTL_NODISCARD _MSTL string_view at(const size_type n) const noexcept override {
+        return field(n).view();
+    }
+
+    MSTL_NODISCARD db_field field(const size_type n) const noexcept override {
         MSTL_DEBUG_VERIFY(cursor, "database_result_row_value can`t dereference nullptr.")
         MSTL_DEBUG_VERIFY(columns > n, "database_result_row_value out of ranges.")
-        return cursor[n];
+        return db_field(cursor[n], field_length(n));
     }
 
     MSTL_NODISCARD bool at_bool(const size_type n) const override {
@@ -198,7 +625,7 @@ public:
         MSTL_DEBUG_VERIFY(columns > n, "database_result_row_value out of ranges.")
         if (column_types_->at(n) != MYSQL_TYPE_BOOL)
             Exception(DatabaseTypeCastError("database type cast to bool mismatch"));
-        return static_cast<bool>(to_int8(cursor[n]));
+        return field(n).as_bool();
     }
 
     MSTL_NODISCARD int8_t at_int8(const size_type n) const override {
@@ -207,7 +634,7 @@ public:
         const auto type = column_types_->at(n);
         if (!(type == MYSQL_TYPE_TINY || type == MYSQL_TYPE_BOOL))
             Exception(DatabaseTypeCastError("database type cast to int8 mismatch"));
-        return to_int8(cursor[n]);
+        return field(n).as_int8();
     }
 
     MSTL_NODISCARD int16_t at_int16(const size_type n) const override {
@@ -216,7 +643,7 @@ public:
         const auto type = column_types_->at(n);
         if (!(type == MYSQL_TYPE_SHORT || type == MYSQL_TYPE_TINY || type == MYSQL_TYPE_BOOL))
             Exception(DatabaseTypeCastError("database type cast to int16 mismatch"));
-        return to_int16(cursor[n]);
+        return field(n).as_int16();
     }
 
     MSTL_NODISCARD int32_t at_int32(const size_type n) const override {
@@ -226,7 +653,7 @@ public:
         if (!(type == MYSQL_TYPE_LONG || type == MYSQL_TYPE_INT24 || type == MYSQL_TYPE_SHORT ||
             type == MYSQL_TYPE_TINY || type == MYSQL_TYPE_BOOL))
             Exception(DatabaseTypeCastError("database type cast to int32 mismatch"));
-        return to_int32(cursor[n]);
+        return field(n).as_int32();
     }
 
     MSTL_NODISCARD int64_t at_int64(const size_type n) const override {
@@ -236,7 +663,7 @@ public:
         if (!(type == MYSQL_TYPE_LONGLONG || type == MYSQL_TYPE_LONG || type == MYSQL_TYPE_INT24 ||
             type == MYSQL_TYPE_SHORT || type == MYSQL_TYPE_TINY || type == MYSQL_TYPE_BOOL))
             Exception(DatabaseTypeCastError("database type cast to int64 mismatch"));
-        return to_int64(cursor[n]);
+        return field(n).as_int64();
     }
 
     MSTL_NODISCARD float32_t at_float32(const size_type n) const override {
@@ -246,7 +673,7 @@ public:
         if (!(type == MYSQL_TYPE_FLOAT || type == MYSQL_TYPE_LONG
             || type == MYSQL_TYPE_SHORT || type == MYSQL_TYPE_TINY))
             Exception(DatabaseTypeCastError("database type cast to float32 mismatch"));
-        return to_float32(cursor[n]);
+        return field(n).as_float32();
     }
 
     MSTL_NODISCARD float64_t at_float64(const size_type n) const override {
@@ -256,7 +683,7 @@ public:
         if (!(type == MYSQL_TYPE_DOUBLE || type == MYSQL_TYPE_FLOAT || type == MYSQL_TYPE_LONGLONG
             || type == MYSQL_TYPE_LONG || type == MYSQL_TYPE_SHORT || type == MYSQL_TYPE_TINY))
             Exception(DatabaseTypeCastError("database type cast to float64 mismatch"));
-        return to_float64(cursor[n]);
+        return field(n).as_float64();
     }
 
     MSTL_NODISCARD decimal_t at_decimal(const size_type n) const override {
@@ -267,7 +694,7 @@ public:
             type == MYSQL_TYPE_FLOAT || type == MYSQL_TYPE_LONGLONG || type == MYSQL_TYPE_LONG ||
             type == MYSQL_TYPE_SHORT || type == MYSQL_TYPE_TINY))
             Exception(DatabaseTypeCastError("database type cast to decimal mismatch"));
-        return to_decimal(cursor[n]);
+        return field(n).as_decimal();
     }
 
     MSTL_NODISCARD _MSTL vector<char> at_blob(const size_type n) const override {
@@ -277,7 +704,7 @@ public:
         if (!(type == MYSQL_TYPE_BLOB || type == MYSQL_TYPE_TINY_BLOB ||
             type == MYSQL_TYPE_MEDIUM_BLOB || type == MYSQL_TYPE_LONG_BLOB))
             Exception(DatabaseTypeCastError("database type cast to blob mismatch"));
-        return {cursor[n], cursor[n] + mysql_fetch_lengths(result)[n]};
+        return field(n).as_blob();
     }
 
     MSTL_NODISCARD _MSTL string at_set(const size_type n) const override {
@@ -286,7 +713,7 @@ public:
         if (column_types_->at(n) != MYSQL_TYPE_SET) {
             Exception(DatabaseTypeCastError("database type cast to SET mismatch"));
         }
-        return cursor[n];
+        return field(n).as_string();
     }
 
     MSTL_NODISCARD uint64_t at_bit(const size_type n) const override {
@@ -295,14 +722,7 @@ public:
         if (column_types_->at(n) != MYSQL_TYPE_BIT) {
             Exception(DatabaseTypeCastError("database type cast to BIT mismatch"));
         }
-        const unsigned long length = mysql_fetch_lengths(result)[n];
-        const char* data = cursor[n];
-
-        uint64_t value = 0;
-        for (unsigned long i = 0; i < length; ++i) {
-            value = (value << 8) | static_cast<byte_t>(data[i]);
-        }
-        return value;
+        return field(n).as_bit();
     }
 
     MSTL_NODISCARD _MSTL date at_date(const size_type n) const override {
@@ -310,15 +730,15 @@ public:
         MSTL_DEBUG_VERIFY(columns > n, "database_result_row_value out of ranges.")
         if (column_types_->at(n) != MYSQL_TYPE_DATE)
             Exception(DatabaseTypeCastError("database type cast to date mismatch"));
-        return _MSTL date::from_string(cursor[n]);
+        return field(n).as_date();
     }
 
     MSTL_NODISCARD _MSTL time at_time(const size_type n) const override {
         MSTL_DEBUG_VERIFY(cursor, "database_result_row_value can`t dereference nullptr.")
         MSTL_DEBUG_VERIFY(columns > n, "database_result_row_value out of ranges.")
-        if (column_types_->at(n) != MYSQL_TYPE_DATE)
+        if (column_types_->at(n) != MYSQL_TYPE_TIME)
             Exception(DatabaseTypeCastError("database type cast to time mismatch"));
-        return _MSTL time::from_string(cursor[n]);
+        return field(n).as_time();
     }
 
     MSTL_NODISCARD _MSTL datetime at_datetime(const size_type n) const override {
@@ -326,7 +746,7 @@ public:
         MSTL_DEBUG_VERIFY(columns > n, "database_result_row_value out of ranges.")
         if (column_types_->at(n) != MYSQL_TYPE_DATETIME)
             Exception(DatabaseTypeCastError("database type cast to datetime mismatch"));
-        return _MSTL datetime::from_string(cursor[n]);
+        return field(n).as_datetime();
     }
 
     MSTL_NODISCARD _MSTL timestamp at_timestamp(const size_type n) const override {
@@ -334,7 +754,7 @@ public:
         MSTL_DEBUG_VERIFY(columns > n, "database_result_row_value out of ranges.")
         if (column_types_->at(n) != MYSQL_TYPE_TIMESTAMP)
             Exception(DatabaseTypeCastError("database type cast to timestamp mismatch"));
-        return _MSTL timestamp(_MSTL datetime::from_string(cursor[n]));
+        return _MSTL timestamp(field(n).as_datetime());
     }
 
     MSTL_NODISCARD string at_string(const size_type n) const noexcept override {
@@ -347,12 +767,130 @@ public:
 };
 
 
-#ifdef MSTL_SUPPORT_MYSQL__
+struct db_mysql_statement final : idb_statement, enable_shared_from_this<db_mysql_statement> {
+private:
+    MYSQL_STMT* stmt_ = nullptr;
+    size_type params_ = 0;
+    vector<MYSQL_BIND> binds_{};
+    vector<int64_t> integers_{};
+    vector<float64_t> floats_{};
+    vector<string> texts_{};
+    vector<unsigned long> lengths_{};
+
+    MYSQL_BIND* reset_bind(const size_type index) {
+        if (index >= params_) return nullptr;
+        MYSQL_BIND* bind = &binds_[index];
+        memory_set(bind, 0, sizeof(MYSQL_BIND));
+        bind->buffer_type = MYSQL_TYPE_NULL;
+        return bind;
+    }
+
+    bool bind_bytes(const size_type index, const char* data, const size_type size, const enum_field_types type) {
+        MYSQL_BIND* bind = reset_bind(index);
+        if (bind == nullptr) return false;
+        texts_[index] = string(data, size);
+        lengths_[index] = static_cast<unsigned long>(size);
+        bind->buffer_type = type;
+        bind->buffer = const_cast<char*>(texts_[index].data());
+        bind->buffer_length = lengths_[index];
+        bind->length = &lengths_[index];
+        return true;
+    }
+
+    bool run() {
+        if (stmt_ == nullptr) return false;
+        if (params_ != 0 && mysql_stmt_bind_param(stmt_, binds_.data())) return false;
+        return mysql_stmt_execute(stmt_) == 0;
+    }
+
+public:
+    db_mysql_statement(MYSQL* mysql, const string& sql) : stmt_(mysql_stmt_init(mysql)) {
+        if (stmt_ == nullptr) return;
+        if (mysql_stmt_prepare(stmt_, sql.data(), static_cast<unsigned long>(sql.size()))) {
+            mysql_stmt_close(stmt_);
+            stmt_ = nullptr;
+            return;
+        }
+        params_ = mysql_stmt_param_count(stmt_);
+        binds_.resize(params_);
+        integers_.resize(params_);
+        floats_.resize(params_);
+        texts_.resize(params_);
+        lengths_.resize(params_);
+        clear_bindings();
+    }
+
+    ~db_mysql_statement() override {
+        if (stmt_) mysql_stmt_close(stmt_);
+    }
+
+    db_mysql_statement(const db_mysql_statement&) = delete;
+    db_mysql_statement& operator =(const db_mysql_statement&) = delete;
+
+    MSTL_NODISCARD bool valid() const noexcept { return stmt_ != nullptr; }
+    MSTL_NODISCARD size_type param_count() const noexcept override { return params_; }
+
+    bool bind_null(const size_type index) override {
+        return reset_bind(index) != nullptr;
+    }
+
+    bool bind_int64(const size_type index, const int64_t value) override {
+        MYSQL_BIND* bind = reset_bind(index);
+        if (bind == nullptr) return false;
+        integers_[index] = value;
+        bind->buffer_type = MYSQL_TYPE_LONGLONG;
+        bind->buffer = &integers_[index];
+        return true;
+    }
+
+    bool bind_float64(const size_type index, const float64_t value) override {
+        MYSQL_BIND* bind = reset_bind(index);
+        if (bind == nullptr) return false;
+        floats_[index] = value;
+        bind->buffer_type = MYSQL_TYPE_DOUBLE;
+        bind->buffer = &floats_[index];
+        return true;
+    }
+
+    bool bind_text(const size_type index, const string_view value) override {
+        return bind_bytes(index, value.data(), value.size(), MYSQL_TYPE_STRING);
+    }
+
+    bool bind_blob(const size_type index, const void* data, const size_type size) override {
+        return bind_bytes(index, static_cast<const char*>(data), size, MYSQL_TYPE_BLOB);
+    }
+
+    void clear_bindings() override {
+        for (size_type i = 0; i < params_; ++i) reset_bind(i);
+    }
+
+    bool execute() override {
+        if (!run()) return false;
+        // drain a result set nobody asked for so the connection stays usable
+        mysql_stmt_free_result(stmt_);
+        return true;
+    }
+
+    unique_ptr<idb_result> query() override {
+        if (!run()) return {};
+        return make_unique<db_mysql_result>(stmt_, shared_ptr<idb_statement>(shared_from_this()));
+    }
+
+    unique_ptr<idb_result> query_stream() override {
+        if (!run()) return {};
+        return make_unique<db_mysql_result>(stmt_, shared_ptr<idb_statement>(shared_from_this()), true);
+    }
+
+    MSTL_NODISCARD uint64_t affected_rows() const override {
+        return stmt_ ? mysql_stmt_affected_rows(stmt_) : 0;
+    }
+};
+
 // database connection is based on MySql connection.
 struct db_mysql_connect final : idb_connect {
 private:
     MYSQL* mysql = nullptr;
-    clock_type alive_time_ = 0;
+    clock_type::time_point alive_time_ = clock_type::now();
 
 public:
     db_mysql_connect() noexcept {
@@ -431,6 +969,13 @@ public:
         return make_unique<db_mysql_result>(mysql_store_result(mysql));
     }
 
+    MSTL_NODISCARD unique_ptr<idb_result> query_stream(const _MSTL string& sql) const noexcept override {
+        if (mysql_query(mysql, sql.c_str())) {
+            return {};
+        }
+        return make_unique<db_mysql_result>(mysql_use_result(mysql), true);
+    }
+
     MSTL_NODISCARD bool connected() const noexcept override {
         return mysql != nullptr;
     }
@@ -439,26 +984,37 @@ public:
     }
 
     void close() noexcept override {
+        clear_statements();
         if (connected()) {
             mysql_close(mysql);
+            mysql = nullptr;
         }
     }
 
     void refresh_alive() noexcept override {
-        alive_time_ = std::clock();
+        alive_time_ = clock_type::now();
     }
-    MSTL_NODISCARD clock_type get_alive() const noexcept override {
-        return std::clock() - alive_time_;
+    MSTL_NODISCARD clock_type::duration get_alive() const noexcept override {
+        return clock_type::now() - alive_time_;
     }
 
     MSTL_NODISCARD bool reset_connect(const db_connect_config& config) override {
         if (connected()) {
+            clear_statements();
             mysql_close(mysql);
             mysql = mysql_init(nullptr);
             return connect_to(config);
         }
         return false;
     }
+
+protected:
+    shared_ptr<idb_statement> create_statement(const string& sql) override {
+        if (!connected()) return nullptr;
+        auto statement = make_shared<db_mysql_statement>(mysql, sql);
+        if (!statement->valid()) return nullptr;
+        return shared_ptr<idb_statement>(_MSTL move(statement));
+    }
 };
 
 class db_mysql_factory final : public idb_factory {
@@ -488,11 +1044,13 @@ private:
     size_type columns = 0;
     list<string_view>* column_names_ = new list<string_view>;
     list<int>* column_types_ = new list<int>;
+    shared_ptr<idb_statement> statement_ = nullptr;  // a prepared statement is reset, not finalized
 
 public:
     db_sqlite_result() noexcept = default;
 
-    explicit db_sqlite_result(sqlite3_stmt* statement) noexcept : stmt(statement) {
+    explicit db_sqlite_result(sqlite3_stmt* statement, shared_ptr<idb_statement> owner = nullptr) noexcept
+        : stmt(statement), statement_(_MSTL move(owner)) {
         if (stmt) {
             columns = sqlite3_column_count(stmt);
             for (int i = 0; i < columns; ++i) {
@@ -504,7 +1062,8 @@ public:
 
     ~db_sqlite_result() override {
         if (stmt) {
-            sqlite3_finalize(stmt);
+            if (statement_) sqlite3_reset(stmt);
+            else sqlite3_finalize(stmt);
         }
         delete column_names_;
         delete column_types_;
@@ -539,8 +1098,13 @@ public:
     }
 
     MSTL_NODISCARD _MSTL string_view at(const size_type index) const noexcept override {
+        return field(index).view();
+    }
+
+    // text points into sqlite's own copy of the column, valid until the next step.
+    MSTL_NODISCARD db_field field(const size_type index) const noexcept override {
         const auto text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, index));
-        return text ? string_view(text) : string_view{};
+        return db_field(text, static_cast<size_t>(sqlite3_column_bytes(stmt, index)));
     }
 
     MSTL_NODISCARD bool at_bool(const size_type index) const override {
@@ -576,8 +1140,9 @@ public:
     }
 
     MSTL_NODISCARD _MSTL vector<char> at_blob(const size_type index) const override {
-        const string_view view = this->at(index);
-        return vector<char>{view.data(), view.data() + view.size()};
+        const auto data = static_cast<const char*>(sqlite3_column_blob(stmt, index));
+        const auto size = static_cast<size_t>(sqlite3_column_bytes(stmt, index));
+        return data ? vector<char>{data, data + size} : vector<char>{};
     }
 
     MSTL_NODISCARD _MSTL string at_set(const size_type index) const override {
@@ -585,12 +1150,7 @@ public:
     }
 
     MSTL_NODISCARD uint64_t at_bit(const size_type index) const noexcept override {
-        const auto data = at(index);
-        uint64_t value = 0;
-        for (size_t i = 0; i < data.size(); ++i) {
-            value = (value << 8) | static_cast<byte_t>(data.at(i));
-        }
-        return value;
+        return field(index).as_bit();
     }
 
     MSTL_NODISCARD _MSTL date at_date(const size_type index) const noexcept override {
@@ -602,11 +1162,7 @@ public:
     }
 
     MSTL_NODISCARD _MSTL datetime at_datetime(const size_type index) const override {
-        const auto text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, index));
-        if (text) {
-            return _MSTL datetime::from_string(text);
-        }
-        return _MSTL datetime{};
+        return field(index).as_datetime();
     }
 
     MSTL_NODISCARD timestamp at_timestamp(const size_type index) const override {
@@ -622,10 +1178,89 @@ public:
     }
 };
 
+struct db_sqlite_statement final : idb_statement, enable_shared_from_this<db_sqlite_statement> {
+private:
+    sqlite3* db_ = nullptr;
+    sqlite3_stmt* stmt_ = nullptr;
+    uint64_t changes_ = 0;
+
+    // sqlite numbers parameters from 1
+    bool bound(const size_type index, const int status) const noexcept {
+        return index < param_count() && status == SQLITE_OK;
+    }
+
+public:
+    db_sqlite_statement(sqlite3* db, const string& sql) : db_(db) {
+        if (sqlite3_prepare_v2(db_, sql.c_str(), -1, &stmt_, nullptr) != SQLITE_OK) {
+            sqlite3_finalize(stmt_);
+            stmt_ = nullptr;
+        }
+    }
+
+    ~db_sqlite_statement() override {
+        if (stmt_) sqlite3_finalize(stmt_);
+    }
+
+    db_sqlite_statement(const db_sqlite_statement&) = delete;
+    db_sqlite_statement& operator =(const db_sqlite_statement&) = delete;
+
+    MSTL_NODISCARD bool valid() const noexcept { return stmt_ != nullptr; }
+
+    MSTL_NODISCARD size_type param_count() const noexcept override {
+        return stmt_ ? sqlite3_bind_parameter_count(stmt_) : 0;
+    }
+
+    bool bind_null(const size_type index) override {
+        return bound(index, sqlite3_bind_null(stmt_, static_cast<int>(index) + 1));
+    }
+
+    bool bind_int64(const size_type index, const int64_t value) override {
+        return bound(index, sqlite3_bind_int64(stmt_, static_cast<int>(index) + 1, value));
+    }
+
+    bool bind_float64(const size_type index, const float64_t value) override {
+        return bound(index, sqlite3_bind_double(stmt_, static_cast<int>(index) + 1, value));
+    }
+
+    bool bind_text(const size_type index, const string_view value) override {
+        return bound(index, sqlite3_bind_text(stmt_, static_cast<int>(index) + 1,
+            value.data(), static_cast<int>(value.size()), SQLITE_TRANSIENT));
+    }
+
+    bool bind_blob(const size_type index, const void* data, const size_type size) override {
+        return bound(index, sqlite3_bind_blob(stmt_, static_cast<int>(index) + 1,
+            data, static_cast<int>(size), SQLITE_TRANSIENT));
+    }
+
+    void clear_bindings() override {
+        if (stmt_) sqlite3_clear_bindings(stmt_);
+    }
+
+    bool execute() override {
+        if (stmt_ == nullptr) return false;
+        sqlite3_reset(stmt_);
+        int status;
+        while ((status = sqlite3_step(stmt_)) == SQLITE_ROW) {}
+        changes_ = sqlite3_changes(db_);
+        sqlite3_reset(stmt_);
+        return status == SQLITE_DONE;
+    }
+
+    unique_ptr<idb_result> query() override {
+        if (stmt_ == nullptr) return {};
+        sqlite3_reset(stmt_);
+        return make_unique<db_sqlite_result>(stmt_, shared_ptr<idb_statement>(shared_from_this()));
+    }
+
+    MSTL_NODISCARD uint64_t affected_rows() const noexcept override {
+        return changes_;
+    }
+};
+
 struct db_sqlite_connect final : idb_connect {
 private:
     mutable sqlite3* db = nullptr;
-    clock_type alive_time_ = 0;
+    clock_type::time_point alive_time_ = clock_type::now();
     mutable string_view last_error_;
 
 public:
@@ -639,12 +1274,10 @@ public:
     bool connect_to(const _MSTL string&, const _MSTL string&,
             const _MSTL string& dbname, const _MSTL string&,
             uint32_t, const _MSTL string&) override {
-        sqlite3_open(dbname.c_str(), &db);
         return connect_to_file(dbname);
     }
 
     bool connect_to(const db_connect_config& config) override {
-        sqlite3_open(config.database.c_str(), &db);
         return connect_to_file(config.database);
     }
 
@@ -716,27 +1349,38 @@ public:
     }
 
     void close() noexcept override {
+        clear_statements();
         if (db) {
-            sqlite3_close(db);
+            // deferred until statements still held elsewhere are finalized
+            sqlite3_close_v2(db);
+            db = nullptr;
         }
     }
 
     void refresh_alive() noexcept override {
-        alive_time_ = std::clock();
+        alive_time_ = clock_type::now();
     }
 
-    MSTL_NODISCARD clock_type get_alive() const noexcept override {
-        return std::clock() - alive_time_;
+    MSTL_NODISCARD clock_type::duration get_alive() const noexcept override {
+        return clock_type::now() - alive_time_;
     }
 
     MSTL_NODISCARD bool reset_connect(const db_connect_config& config) override {
         if (connected()) {
-            sqlite3_close(db);
+            close();
             return connect_to(config);
         }
         return false;
     }
 
+protected:
+    shared_ptr<idb_statement> create_statement(const string& sql) override {
+        if (!connected()) return nullptr;
+        auto statement = make_shared<db_sqlite_statement>(db, sql);
+        if (!statement->valid()) return nullptr;
+        return shared_ptr<idb_statement>(_MSTL move(statement));
+    }
+
 private:
     bool connect_to_file(const string& file_path) {
         if (connected()) {
@@ -760,6 +1404,7 @@ public:
     idb_connect* create_connect() override {
         auto conn = new db_sqlite_connect();
         if (!conn->connect_to(config_)) {
+            delete conn;
             return nullptr;
         }
         return conn;
@@ -778,6 +1423,9 @@ private:
     size_type rows_ = 0;
     list<string_view> column_names_;
     bool is_array_ = false;
+    // text of an integer or nested array reply, built once for the row it belongs to
+    mutable string formatted_;
+    mutable size_type formatted_row_ = 0;
 
 private:
     static string format_redis_reply_element(redisReply* element) {
@@ -829,6 +1477,9 @@ public:
     MSTL_NODISCARD bool empty() const noexcept override {
         return !reply_ || rows_ == 0;
     }
+    MSTL_NODISCARD bool is_error() const noexcept {
+        return reply_ && reply_->type == REDIS_REPLY_ERROR;
+    }
     MSTL_NODISCARD size_type row_count() const noexcept override {
         return rows_;
     }
@@ -845,8 +1496,28 @@ public:
         return cursor_ <= rows_;
     }
 
-    MSTL_NODISCARD string_view at(size_type) const noexcept override {
-        return {at_string(0).data(), at_string(0).length()};
+    MSTL_NODISCARD string_view at(const size_type n) const noexcept override {
+        return field(n).view();
+    }
+
+    // strings point into the reply itself, other types into text kept for the current row.
+    MSTL_NODISCARD db_field field(size_type) const noexcept override {
+        if (empty() || cursor_ == 0) return {};
+        const redisReply* element = is_array_ ? reply_->element[cursor_ - 1] : reply_;
+        switch (element->type) {
+            case REDIS_REPLY_STRING:
+            case REDIS_REPLY_STATUS:
+            case REDIS_REPLY_ERROR:
+                return db_field(element->str, element->len);
+            case REDIS_REPLY_NIL:
+                return {};
+            default:
+                if (formatted_row_ != cursor_) {
+                    formatted_ = format_redis_reply_element(const_cast<redisReply*>(element));
+                    formatted_row_ = cursor_;
+                }
+                return db_field(formatted_.data(), formatted_.size());
+        }
     }
 
     MSTL_NODISCARD bool at_bool(size_type) const override {
@@ -923,18 +1594,45 @@ public:
         return format_redis_reply_element(reply_);
     }
 
-    MSTL_NODISCARD string_view at_enum(size_type) const noexcept override {
-        return {at_string(0).c_str(), at_string(0).length()};
+    MSTL_NODISCARD string_view at_enum(const size_type n) const noexcept override {
+        return field(n).view();
     }
 };
 
 struct db_redis_connect final : idb_connect {
 private:
     redisContext* context_ = nullptr;
-    clock_type alive_time_ = 0;
+    clock_type::time_point alive_time_ = clock_type::now();
     mutable string last_error_;
+    size_t pending_ = 0;  // replies owed by appended commands
+    bool in_multi_ = false;
 
 private:
+    bool appended(const int status) {
+        if (status != REDIS_OK) {
+            last_error_ = context_->errstr;
+            return false;
+        }
+        ++pending_;
+        return true;
+    }
+
+    template <typename T>
+    static string_view as_view(const T& arg) {
+        if constexpr (is_convertible_v<const T&, string_view>) {
+            return string_view(arg);
+        } else {
+            return string_view(arg.data(), arg.size());
+        }
+    }
+
+    // a reply read now would belong to an appended command.
+    bool idle_pipeline() const {
+        if (pending_ == 0) return true;
+        last_error_ = "pipeline has unread replies, flush it first";
+        return false;
+    }
+
     bool authenticate(const string& password) const {
         if (password.empty()) return true;
         const auto reply = static_cast<redisReply*>(redisCommand(context_, "AUTH %s", password.c_str()));
@@ -1030,6 +1728,7 @@ public:
     }
 
     bool update(const string& sql) const override {
+        if (!idle_pipeline()) return false;
         const auto reply = static_cast<redisReply*>(redisCommand(context_, sql.c_str()));
         if (!reply || reply->type == REDIS_REPLY_ERROR) {
             if (reply) {
@@ -1043,6 +1742,7 @@ public:
     }
 
     unique_ptr<idb_result> query(const string& sql) const override {
+        if (!idle_pipeline()) return nullptr;
         const auto reply = static_cast<redisReply*>(redisCommand(context_, sql.c_str()));
         if (!reply || reply->type == REDIS_REPLY_ERROR) {
             if (reply) {
@@ -1075,20 +1775,108 @@ public:
             redisFree(context_);
             context_ = nullptr;
         }
+        pending_ = 0;
+        in_multi_ = false;
     }
 
     void refresh_alive() noexcept override {
-        alive_time_ = std::clock();
+        alive_time_ = clock_type::now();
     }
 
-    clock_type get_alive() const noexcept override {
-        return std::clock() - alive_time_;
+    clock_type::duration get_alive() const noexcept override {
+        return clock_type::now() - alive_time_;
     }
 
     bool reset_connect(const db_connect_config& config) override {
         close();
         return connect_to(config);
     }
+
+    // queues a command formatted like query, nothing is sent before flush.
+    bool append(const string& command) {
+        if (!connected()) return false;
+        return appended(redisAppendCommand(context_, command.c_str()));
+    }
+
+    // queues a command given as separate arguments, binary safe.
+    bool append_argv(const vector<string_view>& args) {
+        if (!connected() || args.empty()) return false;
+        vector<const char*> argv(args.size());
+        vector<size_t> lengths(args.size());
+        for (size_t i = 0; i < args.size(); ++i) {
+            argv[i] = args[i].data();
+            lengths[i] = args[i].size();
+        }
+        return appended(redisAppendCommandArgv(context_, static_cast<int>(args.size()), argv.data(), lengths.data()));
+    }
+
+    template <typename... Args>
+    bool append_args(const Args&... args) {
+        vector<string_view> views;
+        (views.push_back(as_view(args)), ...);
+        return append_argv(views);
+    }
+
+    MSTL_NODISCARD size_t pending() const noexcept { return pending_; }
+
+    // sends every queued command in one write and reads the replies in order.
+    // an error reply is a result with is_error, a broken connection leaves null
+    // results for the replies that never came.
+    vector<shared_ptr<db_redis_result>> flush() {
+        vector<shared_ptr<db_redis_result>> results;
+        results.reserve(pending_);
+        for (; pending_ > 0; --pending_) {
+            void* reply = nullptr;
+            if (redisGetReply(context_, &reply) != REDIS_OK) {
+                last_error_ = context_->errstr;
+                for (; pending_ > 0; --pending_) results.push_back(nullptr);
+                break;
+            }
+            results.push_back(make_shared<db_redis_result>(static_cast<redisReply*>(reply)));
+        }
+        in_multi_ = false;
+        return results;
+    }
+
+    // starts a transaction, the commands appended until exec run atomically.
+    bool multi() {
+        if (in_multi_ || !idle_pipeline()) return false;
+        if (!append("MULTI")) return false;
+        in_multi_ = true;
+        return true;
+    }
+
+    // the EXEC reply, one row per command of the transaction. an error result
+    // when a command was rejected while queueing, null when the connection broke.
+    shared_ptr<db_redis_result> exec() {
+        if (!in_multi_) return nullptr;
+        if (!append("EXEC")) {
+            // the server is left inside MULTI, the session cannot be used any more
+            close();
+            return nullptr;
+        }
+        auto results = flush();
+        return results.back();
+    }
+
+    // drops the transaction, its commands are never run.
+    bool discard() {
+        if (!in_multi_) return false;
+        if (!append("DISCARD")) {
+            close();
+            return false;
+        }
+        auto results = flush();
+        return results.back() && !results.back()->is_error();
+    }
+
+    // an open transaction is discarded and unread replies are dropped.
+    bool recycle() override {
+        if (!connected()) return false;
+        if (in_multi_ && !discard()) return false;
+        if (pending_ > 0) flush();
+        return connected();
+    }
 };
 
 class db_redis_factory final : public idb_factory {
@@ -1111,62 +1899,458 @@ public:
 #endif
 
 
+// a query waiting for a connection of the pool.
+struct __db_pool_job {
+    virtual ~__db_pool_job() = default;
+    virtual void run(idb_connect& conn) = 0;
+    // no connection became available.
+    virtual void fail() = 0;
+};
+
+template <typename Func, typename Result>
+struct __db_pool_future_job final : __db_pool_job {
+    Func func;
+    std::promise<Result> promise{std::allocator_arg, __task_state_allocator<Result>()};
+
+    explicit __db_pool_future_job(Func&& func) : func(_MSTL move(func)) {}
+
+    void run(idb_connect& conn) override {
+        try {
+            if constexpr (is_void_v<Result>) {
+                func(conn);
+                promise.set_value();
+            } else {
+                promise.set_value(func(conn));
+            }
+        } catch (...) {
+            promise.set_exception(std::current_exception());
+        }
+    }
+
+    void fail() override {
+        promise.set_exception(std::make_exception_ptr(DatabaseError("no database connection available")));
+    }
+};
+
+template <typename Func, typename Fail>
+struct __db_pool_callback_job final : __db_pool_job {
+    Func func;
+    Fail on_fail;
+
+    __db_pool_callback_job(Func&& func, Fail&& on_fail)
+        : func(_MSTL move(func)), on_fail(_MSTL move(on_fail)) {}
+
+    void run(idb_connect& conn) override {
+        try {
+            func(conn);
+        } catch (...) {}
+    }
+
+    void fail() override {
+        try {
+            on_fail();
+        } catch (...) {}
+    }
+};
+
+// idle connections sit on lock-free stacks sharded by thread, so checkout and
+// release are a single CAS in the common case. a caller finding every shard
+// empty queues up as a waiter and the next released connection is handed to
+// the oldest waiter directly, waking only that one. new connections are
+// opened by the producer thread, never by the caller.
+//
+// the pool keeps at least init_size connections and min_idle of them idle.
+// idle ones past max_idle_time above init_size and any past a nonzero
+// max_lifetime are closed, and the scanner pings idle ones unused for
+// validate_interval one at a time, claiming each where it lies on its stack,
+// so a checkout pings only what the scanner has not reached yet.
 class database_pool {
 private:
+    static constexpr uint32_t NO_SLOT = ~uint32_t(0);
+    static constexpr size_t MAX_SHARDS = 16;
+
+    // CLAIMED slots sit on a stack while the scanner or producer works on them,
+    // a checkout popping one marks it POPPED and the owner pushes it back later.
+    // DEAD slots sit on a stack without a connection.
+    enum class SLOT_STATE : uint8_t {
+        FREE, IDLE, BUSY, CLAIMED, POPPED, DEAD
+    };
+
+    // a connection owns its slot from creation to destruction.
+    struct __db_pool_slot {
+        idb_connect* conn = nullptr;
+        std::atomic<uint32_t> next{NO_SLOT};
+        std::atomic<SLOT_STATE> state{SLOT_STATE::FREE};
+        idb_connect::clock_type::time_point created{};
+        idb_connect::clock_type::time_point checked{};  // last successful ping
+    };
+
+    // tagged head of a slot stack, the tag in the high half defeats ABA.
+    struct alignas(64) __db_pool_stack {
+        std::atomic<uint64_t> head{NO_SLOT};
+    };
+
+    struct __db_pool_waiter {
+        std::condition_variable cond;
+        uint32_t slot = NO_SLOT;
+    };
+
     db_connect_config config_;
     size_t init_size_;
     size_t max_size_;
-    size_t max_idle_time_;  // s
-    size_t connect_timeout_;  // ms
+    std::chrono::seconds max_idle_time_;
+    std::chrono::milliseconds connect_timeout_;
+    size_t min_idle_;
+    std::chrono::seconds max_lifetime_;
+    std::chrono::seconds validate_interval_;
 
     unique_ptr<idb_factory> factory_ = nullptr;
-    _MSTL queue<idb_connect*> connect_queue_;
-    std::mutex queue_mtx_;
-    std::condition_variable cv_;
+    __db_pool_slot* slots_ = nullptr;
+    __db_pool_stack* shards_ = nullptr;
+    size_t shard_mask_ = 0;
+    __db_pool_stack unused_;  // slots without a connection
+    std::atomic<size_t> total_{0};
+    std::atomic<size_t> idle_{0};
     std::atomic<bool> running_{false};
 
+    std::mutex waiter_mtx_;
+    _MSTL list<__db_pool_waiter*> waiters_;
+    std::atomic<size_t> waiting_{0};
+
+    std::mutex produce_mtx_;
+    std::condition_variable produce_cv_;
+    std::mutex scanner_mtx_;
+    std::condition_variable scanner_cv_;
     std::thread produce_;
     std::thread scanner_;
 
+    thread_pool* executor_ = &get_instance_thread_pool();
+    size_t max_in_flight_;
+    std::mutex async_mtx_;
+    std::condition_variable async_cv_;
+    _MSTL queue<__db_pool_job*> jobs_;
+    size_t runners_ = 0;  // each holds at most one connection
+
     friend database_pool& get_instance_database_pool();
 
 private:
+    void push_slot(__db_pool_stack& stack, const uint32_t index) noexcept {
+        uint64_t head = stack.head.load(std::memory_order_relaxed);
+        uint64_t next;
+        do {
+            slots_[index].next.store(static_cast<uint32_t>(head), std::memory_order_relaxed);
+            next = ((head >> 32) + 1) << 32 | index;
+        } while (!stack.head.compare_exchange_weak(head, next, std::memory_order_seq_cst, std::memory_order_relaxed));
+    }
+
+    uint32_t pop_slot(__db_pool_stack& stack) noexcept {
+        uint64_t head = stack.head.load(std::memory_order_seq_cst);
+        for (;;) {
+            const auto index = static_cast<uint32_t>(head);
+            if (index == NO_SLOT) return NO_SLOT;
+            // may read a stale link when the slot was popped meanwhile, the tag then fails the CAS
+            const uint64_t next = ((head >> 32) + 1) << 32 | slots_[index].next.load(std::memory_order_relaxed);
+            if (stack.head.compare_exchange_weak(head, next, std::memory_order_seq_cst, std::memory_order_relaxed))
+                return index;
+        }
+    }
+
+    size_t home_shard() const noexcept {
+        static thread_local const size_t hint = std::hash<std::thread::id>()(std::this_thread::get_id());
+        return hint & shard_mask_;
+    }
+
+    // settles a slot just popped off a shard, true when it is now checked out.
+    bool take_popped(const uint32_t index) noexcept {
+        std::atomic<SLOT_STATE>& state = slots_[index].state;
+        SLOT_STATE current = state.load(std::memory_order_acquire);
+        for (;;) {
+            switch (current) {
+                case SLOT_STATE::IDLE:
+                    if (state.compare_exchange_weak(current, SLOT_STATE::BUSY, std::memory_order_acq_rel)) {
+                        idle_.fetch_sub(1, std::memory_order_relaxed);
+                        return true;
+                    }
+                    break;
+                case SLOT_STATE::CLAIMED:
+                    if (state.compare_exchange_weak(current, SLOT_STATE::POPPED, std::memory_order_acq_rel))
+                        return false;
+                    break;
+                case SLOT_STATE::DEAD:
+                    if (state.compare_exchange_weak(current, SLOT_STATE::FREE, std::memory_order_acq_rel)) {
+                        push_slot(unused_, index);
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+            }
+        }
+    }
+
+    uint32_t acquire_idle() noexcept {
+        const size_t home = home_shard();
+        for (size_t i = 0; i <= shard_mask_; ++i) {
+            __db_pool_stack& shard = shards_[(home + i) & shard_mask_];
+            for (uint32_t index = pop_slot(shard); index != NO_SLOT; index = pop_slot(shard)) {
+                if (take_popped(index)) return index;
+            }
+        }
+        return NO_SLOT;
+    }
+
+    // takes an idle slot without removing it from its stack.
+    bool claim(const uint32_t index, SLOT_STATE from) noexcept {
+        return slots_[index].state.compare_exchange_strong(from, SLOT_STATE::CLAIMED,
+            std::memory_order_acq_rel, std::memory_order_relaxed);
+    }
+
+    // ends a claim on a slot that holds a connection.
+    void finish_claim(const uint32_t index) {
+        SLOT_STATE expected = SLOT_STATE::CLAIMED;
+        if (slots_[index].state.compare_exchange_strong(expected, SLOT_STATE::IDLE, std::memory_order_acq_rel)) {
+            idle_.fetch_add(1, std::memory_order_relaxed);
+            // a waiter may have found the stacks empty while the slot was claimed
+            if (waiting_.load(std::memory_order_seq_cst) > 0) {
+                const uint32_t found = acquire_idle();
+                if (found != NO_SLOT) release_idle(found);
+            }
+            return;
+        }
+        slots_[index].state.store(SLOT_STATE::BUSY, std::memory_order_relaxed);
+        release_idle(index);
+    }
+
+    // ends a claim on a slot whose connection is gone.
+    void drop_claim(const uint32_t index) noexcept {
+        SLOT_STATE expected = SLOT_STATE::CLAIMED;
+        if (slots_[index].state.compare_exchange_strong(expected, SLOT_STATE::DEAD, std::memory_order_acq_rel)) return;
+        slots_[index].state.store(SLOT_STATE::FREE, std::memory_order_relaxed);
+        push_slot(unused_, index);
+    }
+
+    // gives the slot to the oldest waiter, false when nobody waits.
+    bool handoff(const uint32_t index) {
+        std::lock_guard<std::mutex> lock(waiter_mtx_);
+        if (waiters_.empty()) return false;
+        __db_pool_waiter* waiter = waiters_.front();
+        waiters_.pop_front();
+        waiting_.fetch_sub(1, std::memory_order_seq_cst);
+        waiter->slot = index;
+        waiter->cond.notify_one();
+        return true;
+    }
+
+    void release_idle(uint32_t index) {
+        if (waiting_.load(std::memory_order_seq_cst) > 0 && handoff(index)) return;
+        for (;;) {
+            slots_[index].state.store(SLOT_STATE::IDLE, std::memory_order_release);
+            push_slot(shards_[home_shard()], index);
+            idle_.fetch_add(1, std::memory_order_relaxed);
+            // a waiter queued after the check above may have missed the push
+            if (waiting_.load(std::memory_order_seq_cst) == 0) return;
+            index = acquire_idle();
+            if (index == NO_SLOT || handoff(index)) return;
+        }
+    }
+
+    uint32_t wait_idle() {
+        __db_pool_waiter self;
+        std::unique_lock<std::mutex> lock(waiter_mtx_);
+        waiters_.push_back(&self);
+        waiting_.fetch_add(1, std::memory_order_seq_cst);
+        lock.unlock();
+        notify_producer();
+
+        const uint32_t found = acquire_idle();
+        lock.lock();
+        if (found == NO_SLOT) {
+            const auto deadline = std::chrono::steady_clock::now() + connect_timeout_;
+            while (self.slot == NO_SLOT && running_) {
+                if (self.cond.wait_until(lock, deadline) == std::cv_status::timeout) break;
+            }
+        }
+        if (self.slot == NO_SLOT) {
+            waiters_.remove(&self);
+            waiting_.fetch_sub(1, std::memory_order_seq_cst);
+            return found;
+        }
+        if (found != NO_SLOT) {
+            // handed one while finding another
+            lock.unlock();
+            release_idle(found);
+        }
+        return self.slot;
+    }
+
+    void notify_producer() {
+        std::lock_guard<std::mutex> lock(produce_mtx_);
+        produce_cv_.notify_one();
+    }
+
+    bool need_connect() const noexcept {
+        const size_t total = total_.load(std::memory_order_relaxed);
+        if (total >= max_size_) return false;
+        // idle_ may wrap below zero for a moment between a pop and its count
+        const auto idle = static_cast<ptrdiff_t>(idle_.load(std::memory_order_relaxed));
+        return waiting_.load(std::memory_order_relaxed) > 0 || total < init_size_ ||
+            idle < static_cast<ptrdiff_t>(min_idle_);
+    }
+
+    // a max_lifetime of 0 keeps connections for as long as they stay valid.
+    bool expired(const __db_pool_slot& slot, const idb_connect::clock_type::time_point now) const noexcept {
+        return max_lifetime_.count() != 0 && now - slot.created >= max_lifetime_;
+    }
+
+    // a slot closed by the scanner stays on its stack until popped, so with
+    // no unused slot left one of those is refilled where it lies.
+    uint32_t claim_dead() noexcept {
+        for (uint32_t index = 0; index < max_size_; ++index) {
+            if (claim(index, SLOT_STATE::DEAD)) return index;
+        }
+        return NO_SLOT;
+    }
+
+    bool open_connect() {
+        uint32_t index = pop_slot(unused_);
+        const bool claimed = index == NO_SLOT;
+        if (claimed) index = claim_dead();
+        if (index == NO_SLOT) return false;
+        idb_connect* conn = nullptr;
+        try {
+            conn = factory_->create_connect();
+        } catch (...) {}
+        if (conn == nullptr) {
+            if (claimed) drop_claim(index);
+            else push_slot(unused_, index);
+            return false;
+        }
+        conn->refresh_alive();
+        slots_[index].conn = conn;
+        slots_[index].created = slots_[index].checked = idb_connect::clock_type::now();
+        total_.fetch_add(1, std::memory_order_relaxed);
+        if (claimed) finish_claim(index);
+        else release_idle(index);
+        return true;
+    }
+
+    void close_connect(const uint32_t index) noexcept {
+        delete slots_[index].conn;
+        slots_[index].conn = nullptr;
+        total_.fetch_sub(1, std::memory_order_relaxed);
+    }
+
+    void discard(const uint32_t index) {
+        close_connect(index);
+        slots_[index].state.store(SLOT_STATE::FREE, std::memory_order_relaxed);
+        push_slot(unused_, index);
+    }
+
+    // one connection at a time, failed attempts back off exponentially so
+    // a restarting server is not hit by a connection storm.
     void produce_connect_task() {
-        while (true) {
+        static constexpr std::chrono::milliseconds MAX_BACKOFF{5000};
+        std::chrono::milliseconds backoff = connect_timeout_;
+        std::unique_lock<std::mutex> lock(produce_mtx_);
+        while (running_) {
+            produce_cv_.wait(lock, [this] { return !running_ || need_connect(); });
             if (!running_) break;
-            std::unique_lock<std::mutex> lock(queue_mtx_);
-            while (!connect_queue_.empty()) {
-                cv_.wait(lock);
-                if (!running_) break;
+            lock.unlock();
+            const bool opened = open_connect();
+            lock.lock();
+            if (opened) {
+                backoff = connect_timeout_;
+            } else {
+                produce_cv_.wait_for(lock, backoff, [this] { return !running_; });
+                backoff = _MSTL min(backoff * 2, MAX_BACKOFF);
             }
-            if (!running_) break;
-            if (connect_queue_.size() < max_size_) {
-                auto* p = factory_->create_connect();
-                if (p != nullptr) {
-                    p->refresh_alive();
-                    connect_queue_.push(p);
-                }
+        }
+    }
+
+    // claims one idle connection at a time where it lies, the others stay
+    // available. expired and surplus ones are closed, stale ones pinged.
+    void scan_idle() {
+        bool closed = false;
+        for (uint32_t index = 0; index < max_size_ && running_; ++index) {
+            if (!claim(index, SLOT_STATE::IDLE)) continue;
+            idle_.fetch_sub(1, std::memory_order_relaxed);
+            __db_pool_slot& slot = slots_[index];
+            const auto now = idb_connect::clock_type::now();
+            const bool surplus = slot.conn->get_alive() >= max_idle_time_ &&
+                idle_.load(std::memory_order_relaxed) >= min_idle_ &&
+                total_.load(std::memory_order_relaxed) > init_size_;
+            if (expired(slot, now) || surplus ||
+                (now - slot.checked >= validate_interval_ && !slot.conn->is_valid())) {
+                close_connect(index);
+                drop_claim(index);
+                closed = true;
+                continue;
             }
-            cv_.notify_all();
+            if (now - slot.checked >= validate_interval_) slot.checked = idb_connect::clock_type::now();
+            finish_claim(index);
         }
+        if (closed) notify_producer();
     }
 
     void scanner_connect_task() {
-        while (true) {
-            if (!running_) break;
-            std::this_thread::sleep_for(std::chrono::seconds(max_idle_time_));
+        const auto period = _MSTL min(validate_interval_, max_idle_time_);
+        std::unique_lock<std::mutex> lock(scanner_mtx_);
+        while (running_) {
+            scanner_cv_.wait_for(lock, period, [this] { return !running_; });
             if (!running_) break;
-            std::unique_lock<std::mutex> lock(queue_mtx_);
+            lock.unlock();
+            scan_idle();
+            lock.lock();
+        }
+    }
+
+    void dispatch(__db_pool_job* job) {
+        thread_pool* executor;
+        {
+            std::lock_guard<std::mutex> lock(async_mtx_);
+            jobs_.push(job);
+            // a busy runner picks the job up once its current one is done
+            if (runners_ >= max_in_flight_) return;
+            ++runners_;
+            executor = executor_;
+        }
+        if (!executor->running() || !executor->post([this] { run_jobs(); })) {
+            run_jobs();
+        }
+    }
 
-            while (connect_queue_.size() > init_size_) {
-                idb_connect* ptr = connect_queue_.front();
-                if (ptr->get_alive() >= max_idle_time_ * 1000) {
-                    connect_queue_.pop();
-                    delete ptr;
+    // checks out one connection and runs queued jobs on it until none are left.
+    void run_jobs() {
+        _MSTL shared_ptr<idb_connect> conn;
+        for (;;) {
+            {
+                std::unique_lock<std::mutex> lock(async_mtx_);
+                if (jobs_.empty() && conn) {
+                    // back to the pool before the destructor may see no runners
+                    lock.unlock();
+                    conn.reset();
+                    lock.lock();
+                }
+                if (jobs_.empty()) {
+                    --runners_;
+                    async_cv_.notify_all();
+                    return;
                 }
-                else
-                    break;
             }
+            if (!conn) conn = get_connect();
+
+            __db_pool_job* job;
+            {
+                std::lock_guard<std::mutex> lock(async_mtx_);
+                job = jobs_.front();
+                jobs_.pop();
+            }
+            if (conn) {
+                job->run(*conn);
+            } else {
+                job->fail();
+            }
+            delete job;
         }
     }
 
@@ -1174,9 +2358,13 @@ public:
     database_pool(
         const DB_TYPE type, const db_connect_config& config,
         const size_t init_size = 50, const size_t max_size = 1024,
-        const size_t max_idle_time = 30, const size_t connect_timeout = 100) :
-    config_(config), init_size_(init_size), max_size_(max_size), max_idle_time_(max_idle_time),
-    connect_timeout_(connect_timeout), running_(true) {
+        const size_t max_idle_time = 30, const size_t connect_timeout = 100,
+        const size_t min_idle = 2, const size_t max_lifetime = 1800, const size_t validate_interval = 5) :
+    config_(config), init_size_(_MSTL min(init_size, max_size)), max_size_(max_size),
+    max_idle_time_(_MSTL max(max_idle_time, size_t(1))), connect_timeout_(connect_timeout),
+    min_idle_(_MSTL min(min_idle, max_size)), max_lifetime_(max_lifetime),
+    validate_interval_(_MSTL max(validate_interval, size_t(1))), running_(true),
+    max_in_flight_(_MSTL max(max_size, size_t(1))) {
         switch(type) {
 #ifdef MSTL_SUPPORT_MYSQL__
             case DB_TYPE::MYSQL:
@@ -1199,23 +2387,39 @@ public:
                 break;
         }
 
+        size_t shards = 1;
+        const size_t cores = std::thread::hardware_concurrency();
+        while (shards < MAX_SHARDS && shards * 2 <= cores) shards <<= 1;
+        shard_mask_ = shards - 1;
+        shards_ = new __db_pool_stack[shards];
+        slots_ = new __db_pool_slot[max_size_];
+        for (size_t i = max_size_; i > 0; --i) {
+            push_slot(unused_, static_cast<uint32_t>(i - 1));
+        }
+
+        // a failed connection is retried by the producer instead of here
         for (size_t i = 0; i < init_size_; i++) {
-            auto* p = factory_->create_connect();
-            if (p != nullptr) {
-                p->refresh_alive();
-                connect_queue_.push(p);
-            }
-            else {
-                --i;
-            }
+            if (!open_connect()) break;
         }
         produce_ = std::thread([this] { produce_connect_task(); });
         scanner_ = std::thread([this] { scanner_connect_task(); });
     }
 
     ~database_pool() {
+        {
+            std::unique_lock<std::mutex> lock(async_mtx_);
+            async_cv_.wait(lock, [this] { return runners_ == 0; });
+        }
         running_ = false;
-        cv_.notify_all();
+        notify_producer();
+        {
+            std::lock_guard<std::mutex> lock(scanner_mtx_);
+            scanner_cv_.notify_all();
+        }
+        {
+            std::lock_guard<std::mutex> lock(waiter_mtx_);
+            for (__db_pool_waiter* waiter : waiters_) waiter->cond.notify_one();
+        }
 
         if (produce_.joinable()) {
             produce_.join();
@@ -1224,10 +2428,11 @@ public:
             scanner_.join();
         }
 
-        while (!connect_queue_.empty()) {
-            delete connect_queue_.front();
-            connect_queue_.pop();
+        for (size_t i = 0; i < max_size_; ++i) {
+            delete slots_[i].conn;
         }
+        delete[] slots_;
+        delete[] shards_;
     }
 
     database_pool(const database_pool&) = delete;
@@ -1235,63 +2440,102 @@ public:
     database_pool(database_pool&&) = delete;
     database_pool& operator=(database_pool&&) = delete;
 
+    // null when no connection frees up within the connect timeout. a checkout
+    // never reconnects, a dead connection is closed and the next one tried.
     _MSTL shared_ptr<idb_connect> get_connect() {
-        std::unique_lock<std::mutex> lock(queue_mtx_);
-
-        while (connect_queue_.empty()) {
-            if (cv_.wait_for(lock,
-                std::chrono::milliseconds(connect_timeout_)) == std::cv_status::timeout) {
-                if (connect_queue_.empty()) {
-                    if (connect_queue_.size() < max_size_) {
-                        auto* new_conn = factory_->create_connect();
-                        if (new_conn != nullptr) {
-                            new_conn->refresh_alive();
-                            connect_queue_.push(new_conn);
-                            continue;
-                        }
-                    }
-                    return nullptr;
-                }
+        uint32_t index;
+        for (;;) {
+            index = acquire_idle();
+            if (index == NO_SLOT) {
+                index = wait_idle();
+                if (index == NO_SLOT) return nullptr;
+            } else if (need_connect()) {
+                notify_producer();
             }
-        }
-
-        idb_connect* raw_conn = connect_queue_.front();
-        connect_queue_.pop();
 
-        if (!raw_conn->is_valid()) {
-            try {
-                if (!raw_conn->reset_connect(config_)) {
-                    delete raw_conn;
-                    raw_conn = factory_->create_connect();
-                    if (raw_conn == nullptr) {
-                        cv_.notify_all();
-                        return nullptr;
-                    }
-                }
+            __db_pool_slot& slot = slots_[index];
+            const auto now = idb_connect::clock_type::now();
+            if (expired(slot, now)) {
+                discard(index);
+                notify_producer();
+                continue;
             }
-            catch (...) {
-                delete raw_conn;
-                cv_.notify_all();
-                return nullptr;
+            if (now - slot.checked >= validate_interval_ && slot.conn->get_alive() >= validate_interval_) {
+                if (!slot.conn->is_valid()) {
+                    discard(index);
+                    notify_producer();
+                    continue;
+                }
+                slot.checked = now;
             }
+            break;
         }
 
-        auto conn_ptr = _MSTL shared_ptr<idb_connect>(raw_conn,
-            [this](idb_connect* p) {
-                std::unique_lock<std::mutex> lock1(queue_mtx_);
-                if (p->is_valid()) {
+        return _MSTL shared_ptr<idb_connect>(slots_[index].conn,
+            [this, index](idb_connect* p) {
+                if (p->connected() && p->recycle()) {
                     p->refresh_alive();
-                    connect_queue_.push(p);
+                    release_idle(index);
                 }
                 else {
-                    delete p;
+                    discard(index);
+                    notify_producer();
                 }
-                cv_.notify_all();
             }
         );
+    }
 
-        cv_.notify_all();
-        return conn_ptr;
+    // runs func(idb_connect&) on a pooled connection from the executor's
+    // threads. the future fails with DatabaseError when no connection frees
+    // up within the connect timeout. without a running executor the caller
+    // runs the queue itself.
+    template <typename Func, typename Result = invoke_result_t<decay_t<Func>&, idb_connect&>>
+    std::future<Result> submit(Func&& func) {
+        auto* job = new __db_pool_future_job<decay_t<Func>, Result>(decay_t<Func>(_MSTL forward<Func>(func)));
+        std::future<Result> result = job->promise.get_future();
+        dispatch(job);
+        return result;
+    }
+
+    // like submit without a future, on_fail runs instead of func when no
+    // connection could be had. exceptions of both are dropped.
+    template <typename Func, typename Fail>
+    void post(Func&& func, Fail&& on_fail) {
+        dispatch(new __db_pool_callback_job<decay_t<Func>, decay_t<Fail>>(
+            decay_t<Func>(_MSTL forward<Func>(func)), decay_t<Fail>(_MSTL forward<Fail>(on_fail))));
+    }
+
+    template <typename Func>
+    void post(Func&& func) {
+        post(_MSTL forward<Func>(func), [] {});
+    }
+
+    std::future<bool> async_update(const string& sql) {
+        return submit([sql](idb_connect& conn) { return conn.update(sql); });
+    }
+
+    // the threads queries run on, the pool must be gone before them.
+    void set_executor(thread_pool& executor) {
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        executor_ = &executor;
+    }
+
+    // connections the queued queries may occupy at once, max_size by default.
+    void set_max_in_flight(const size_t count) {
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        max_in_flight_ = _MSTL max(count, size_t(1));
+    }
+
+    MSTL_NODISCARD size_t pending_queries() {
+        std::lock_guard<std::mutex> lock(async_mtx_);
+        return jobs_.size();
+    }
+
+    MSTL_NODISCARD size_t size() const noexcept {
+        return total_.load(std::memory_order_relaxed);
+    }
+    MSTL_NODISCARD size_t idle_size() const noexcept {
+        return idle_.load(std::memory_order_relaxed);
     }
 };
 
@@ -2,177 +2,131 @@
 #define MSTL_LOCK_FREE_QUEUE_HPP__
 #include <atomic>
 #include "MSTL/core/memory.hpp"
+#include "reclamation.hpp"
 MSTL_BEGIN_NAMESPACE__
 
+// unbounded Michael-Scott queue, popped nodes are freed through hazard pointers.
+// define MSTL_LOCK_FREE_STATISTICS__ to count operations per queue.
 template <typename T>
 class lock_free_queue {
 private:
-    struct node_counter {
-        uint32_t internal_count : 30;
-        uint32_t external_counters : 2;
-    };
-
-    struct node;
-
-    struct counted_node_ptr {
-        int external_count;
-        node* ptr;
-
-        counted_node_ptr() : external_count(0), ptr(nullptr) {}
-    };
-
     struct node {
-        std::atomic<T*> data;
-        std::atomic<node_counter> count;
-        std::atomic<counted_node_ptr> next;
+        std::atomic<node*> next{nullptr};
+        alignas(T) byte_t storage[sizeof(T)];  // empty in the dummy head
 
-        node(int external_count = 2) {
-            node_counter new_count;
-            new_count.internal_count = 0;
-            new_count.external_counters = external_count;
-            count.store(new_count);
-
-            counted_node_ptr node_ptr;
-			node_ptr.ptr = nullptr;
-			node_ptr.external_count = 0;
+        T* value() noexcept { return reinterpret_cast<T*>(storage); }
+    };
 
-            next.store(node_ptr);
-        }
+    alignas(64) std::atomic<node*> head_;
+    alignas(64) std::atomic<node*> tail_;
+#ifdef MSTL_LOCK_FREE_STATISTICS__
+    std::atomic<size_t> push_count_{0};
+    std::atomic<size_t> pop_count_{0};
+#endif
 
-        void release_ref() {
-            node_counter old_counter = count.load(std::memory_order_relaxed);
-            node_counter new_counter;
-            do {
-                new_counter = old_counter;
-                --new_counter.internal_count;
+    void link(node* new_node) {
+        hazard_pointer hp;
+        for (;;) {
+            node* tail = hp.protect(tail_);
+            node* next = tail->next.load(std::memory_order_acquire);
+            if (tail != tail_.load(std::memory_order_acquire)) continue;
+            if (next != nullptr) {
+                // help a lagging push move the tail along
+                tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
             }
-            while (!count.compare_exchange_strong(old_counter, new_counter,
-                std::memory_order_acquire, std::memory_order_relaxed));
-            if (!new_counter.internal_count && !new_counter.external_counters) {
-                delete this;
-                destruct_count.fetch_add(1);
+            if (tail->next.compare_exchange_weak(next, new_node, std::memory_order_release, std::memory_order_relaxed)) {
+                tail_.compare_exchange_strong(tail, new_node, std::memory_order_release, std::memory_order_relaxed);
+                break;
             }
         }
-    };
-
-private:
-    static std::atomic<int> destruct_count;
-    static std::atomic<int> construct_count;
-
-    std::atomic<counted_node_ptr> head;
-    std::atomic<counted_node_ptr> tail;
-
-private:
-    void set_new_tail(counted_node_ptr& old_tail, counted_node_ptr const& new_tail) {
-        node* const current_tail_ptr = old_tail.ptr;
-        while (!tail.compare_exchange_weak(old_tail, new_tail) &&
-            old_tail.ptr == current_tail_ptr) {}
-        if (old_tail.ptr == current_tail_ptr)
-            lock_free_queue::free_external_counter(old_tail);
-        else
-            current_tail_ptr->release_ref();
+#ifdef MSTL_LOCK_FREE_STATISTICS__
+        push_count_.fetch_add(1, std::memory_order_relaxed);
+#endif
     }
 
-    static void free_external_counter(counted_node_ptr& old_node_ptr) {
-        node* const ptr = old_node_ptr.ptr;
-        int const count_increase = old_node_ptr.external_count - 2;
-        node_counter old_counter = ptr->count.load(std::memory_order_relaxed);
-        node_counter new_counter;
-        do {
-            new_counter = old_counter;
-            --new_counter.external_counters;
-            new_counter.internal_count += count_increase;
-        }
-        while (!ptr->count.compare_exchange_strong(old_counter, new_counter,
-            std::memory_order_acquire, std::memory_order_relaxed));
-        if (!new_counter.internal_count && !new_counter.external_counters) {
-            destruct_count.fetch_add(1);
-            delete ptr;
+    // hands the front value to consume, false when the queue is empty.
+    template <typename Consume>
+    bool unlink(Consume&& consume) {
+        hazard_pointer hp_head;
+        hazard_pointer hp_next;
+        for (;;) {
+            node* head = hp_head.protect(head_);
+            node* tail = tail_.load(std::memory_order_acquire);
+            node* next = hp_next.protect(head->next);
+            if (head != head_.load(std::memory_order_acquire)) continue;
+            if (next == nullptr) return false;
+            if (head == tail) {
+                tail_.compare_exchange_weak(tail, next, std::memory_order_release, std::memory_order_relaxed);
+                continue;
+            }
+            if (head_.compare_exchange_weak(head, next, std::memory_order_acq_rel, std::memory_order_relaxed)) {
+                // next is the new dummy, only the winner of the CAS touches its value
+                consume(_MSTL move(*next->value()));
+                next->value()->~T();
+                hp_head.reset();
+                hazard_retire(head);
+#ifdef MSTL_LOCK_FREE_STATISTICS__
+                pop_count_.fetch_add(1, std::memory_order_relaxed);
+#endif
+                return true;
+            }
         }
     }
 
-    static void increase_external_count(std::atomic<counted_node_ptr>& counter, counted_node_ptr& old_counter) {
-        counted_node_ptr new_counter;
-        do {
-            new_counter = old_counter;
-            ++new_counter.external_count;
-        } while (!counter.compare_exchange_strong(old_counter, new_counter,
-            std::memory_order_acquire, std::memory_order_relaxed));
-        old_counter.external_count = new_counter.external_count;
-    }
-
 public:
     lock_free_queue() {
-		counted_node_ptr new_next;
-		new_next.ptr = new node();
-		new_next.external_count = 1;
-		tail.store(new_next);
-		head.store(new_next);
+        node* dummy = new node();
+        head_.store(dummy, std::memory_order_relaxed);
+        tail_.store(dummy, std::memory_order_relaxed);
     }
 
+    lock_free_queue(const lock_free_queue&) = delete;
+    lock_free_queue& operator =(const lock_free_queue&) = delete;
+
     ~lock_free_queue() {
-        while (pop()) {}
-        auto head_counted_node = head.load();
-        delete head_counted_node.ptr;
+        node* current = head_.load(std::memory_order_relaxed);
+        node* next = current->next.load(std::memory_order_relaxed);
+        delete current;
+        while (next != nullptr) {
+            current = next;
+            next = current->next.load(std::memory_order_relaxed);
+            current->value()->~T();
+            delete current;
+        }
     }
 
-    void push(T new_value) {
-        _MSTL unique_ptr<T> new_data(new T(new_value));
-        counted_node_ptr new_next;
-        new_next.ptr = new node;
-        new_next.external_count = 1;
-        counted_node_ptr old_tail = tail.load();
-        for (;;) {
-            lock_free_queue::increase_external_count(tail, old_tail);
-            T* old_data = nullptr;
-            if (old_tail.ptr->data.compare_exchange_strong(old_data, new_data.get())) {
-                counted_node_ptr old_next;
-                counted_node_ptr now_next = old_tail.ptr->next.load();
-                if (!old_tail.ptr->next.compare_exchange_strong(old_next, new_next)) {
-                    delete new_next.ptr;
-                    new_next = old_next;
-                }
-                this->set_new_tail(old_tail, new_next);
-                new_data.release();
-                break;
-            }
-            else {
-                counted_node_ptr old_next;
-                if (old_tail.ptr->next.compare_exchange_strong(old_next, new_next)) {
-                    old_next = new_next;
-                    new_next.ptr = new node;
-                }
-                this->set_new_tail(old_tail, old_next);
-            }
-        }
-        ++construct_count;
+    template <typename... Args>
+    void emplace(Args&&... args) {
+        node* new_node = new node();
+        ::new(static_cast<void*>(new_node->storage)) T(_MSTL forward<Args>(args)...);
+        link(new_node);
     }
 
+    void push(const T& value) { emplace(value); }
+    void push(T&& value) { emplace(_MSTL move(value)); }
+
+    bool try_pop(T& out) {
+        return unlink([&out](T&& value) { out = _MSTL move(value); });
+    }
+
+    // null when the queue is empty.
     unique_ptr<T> pop() {
-        counted_node_ptr old_head = head.load(std::memory_order_relaxed);
-        for (;;) {
-            lock_free_queue::increase_external_count(head, old_head);
-            node* const ptr = old_head.ptr;
-            if (ptr == tail.load().ptr) {
-                ptr->release_ref();
-                return _MSTL make_unique<T>();
-            }
-            counted_node_ptr next = ptr->next.load();
-            if (head.compare_exchange_strong(old_head, next)) {
-                T* const res = ptr->data.exchange(nullptr);
-                lock_free_queue::free_external_counter(old_head);
-                return _MSTL make_unique<T>(res);
-            }
-            ptr->release_ref();
-        }
+        unique_ptr<T> result;
+        unlink([&result](T&& value) { result = _MSTL make_unique<T>(_MSTL move(value)); });
+        return result;
     }
-};
 
-template <typename T>
-std::atomic<int> lock_free_queue<T>::destruct_count = 0;
+    MSTL_NODISCARD bool empty() const {
+        hazard_pointer hp;
+        return hp.protect(head_)->next.load(std::memory_order_acquire) == nullptr;
+    }
 
-template <typename T>
-std::atomic<int> lock_free_queue<T>::construct_count = 0;
+#ifdef MSTL_LOCK_FREE_STATISTICS__
+    MSTL_NODISCARD size_t push_count() const noexcept { return push_count_.load(std::memory_order_relaxed); }
+    MSTL_NODISCARD size_t pop_count() const noexcept { return pop_count_.load(std::memory_order_relaxed); }
+#endif
+};
 
 MSTL_END_NAMESPACE__
 #endif // MSTL_LOCK_FREE_QUEUE_HPP__
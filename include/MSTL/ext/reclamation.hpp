@@ -0,0 +1,389 @@
+#ifndef MSTL_RECLAMATION_HPP__
+#define MSTL_RECLAMATION_HPP__
+#include <atomic>
+#include <mutex>
+#include "MSTL/core/algo.hpp"
+#include "MSTL/core/vector.hpp"
+MSTL_BEGIN_NAMESPACE__
+
+// safe memory reclamation for lock-free containers. a node unlinked by one
+// thread may still be read by another, so it is retired instead of deleted and
+// freed once no thread can hold it. two schemes are offered:
+// hazard pointers bound the garbage and suit long reads of a few nodes,
+// epochs make each operation cheaper but a stalled thread delays every free.
+
+struct __retired_node {
+    void* ptr = nullptr;
+    void (*deleter)(void*) = nullptr;
+    uint64_t epoch = 0;
+
+    __retired_node() = default;
+    __retired_node(void* ptr, void (*deleter)(void*), const uint64_t epoch = 0)
+    : ptr(ptr), deleter(deleter), epoch(epoch) {}
+
+    void reclaim() const {
+        deleter(ptr);
+    }
+};
+
+template <typename T>
+void __reclaim_delete(void* ptr) {
+    delete static_cast<T*>(ptr);
+}
+
+
+class __hazard_registry {
+public:
+    static constexpr size_t SLOTS_PER_THREAD = 4;
+
+    struct __hazard_record {
+        std::atomic<const void*> slots[SLOTS_PER_THREAD] = {};
+        std::atomic<bool> in_use{false};
+        __hazard_record* next = nullptr;
+    };
+
+private:
+    std::atomic<__hazard_record*> records_{nullptr};
+    std::atomic<size_t> record_count_{0};
+    std::mutex orphan_mtx_;
+    vector<__retired_node> orphans_;
+
+    struct __thread_state {
+        __hazard_record* record = nullptr;
+        uint32_t used = 0;
+        vector<__retired_node> retired;
+
+        ~__thread_state() {
+            if (record == nullptr) return;
+            __hazard_registry& registry = instance();
+            registry.scan(retired);
+            if (!retired.empty()) {
+                std::lock_guard<std::mutex> lock(registry.orphan_mtx_);
+                for (const auto& node : retired) registry.orphans_.push_back(node);
+            }
+            record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    __hazard_registry() = default;
+
+    // frees every node of the list no hazard slot points to.
+    void scan(vector<__retired_node>& retired) {
+        vector<const void*> hazards;
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        for (__hazard_record* rec = records_.load(std::memory_order_acquire); rec; rec = rec->next) {
+            for (const auto& slot : rec->slots) {
+                if (const void* ptr = slot.load(std::memory_order_seq_cst)) hazards.push_back(ptr);
+            }
+        }
+        _MSTL sort(hazards.begin(), hazards.end());
+
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); ++i) {
+            const auto it = _MSTL lower_bound(hazards.begin(), hazards.end(),
+                static_cast<const void*>(retired[i].ptr));
+            if (it != hazards.end() && *it == retired[i].ptr) {
+                retired[kept++] = retired[i];
+            } else {
+                retired[i].reclaim();
+            }
+        }
+        while (retired.size() > kept) retired.pop_back();
+    }
+
+public:
+    static __hazard_registry& instance() {
+        static __hazard_registry registry;
+        return registry;
+    }
+
+    static __thread_state& thread_state() {
+        static thread_local __thread_state state;
+        return state;
+    }
+
+    __hazard_record* acquire_record() {
+        for (__hazard_record* rec = records_.load(std::memory_order_acquire); rec; rec = rec->next) {
+            bool expected = false;
+            if (!rec->in_use.load(std::memory_order_relaxed) &&
+                rec->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return rec;
+            }
+        }
+        auto* rec = new __hazard_record();
+        rec->in_use.store(true, std::memory_order_relaxed);
+        __hazard_record* head = records_.load(std::memory_order_relaxed);
+        do {
+            rec->next = head;
+        } while (!records_.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+        record_count_.fetch_add(1, std::memory_order_relaxed);
+        return rec;
+    }
+
+    void retire(void* ptr, void (*deleter)(void*)) {
+        __thread_state& state = thread_state();
+        if (state.record == nullptr) state.record = acquire_record();
+        state.retired.push_back(__retired_node(ptr, deleter));
+
+        // scanning once the list outgrows the slots keeps the cost amortized O(1)
+        const size_t threshold = _MSTL max(size_t(64),
+            2 * SLOTS_PER_THREAD * record_count_.load(std::memory_order_relaxed));
+        if (state.retired.size() >= threshold) reclaim();
+    }
+
+    void reclaim() {
+        __thread_state& state = thread_state();
+        {
+            std::lock_guard<std::mutex> lock(orphan_mtx_);
+            for (const auto& node : orphans_) state.retired.push_back(node);
+            orphans_.clear();
+        }
+        scan(state.retired);
+    }
+
+    ~__hazard_registry() {
+        for (const auto& node : orphans_) node.reclaim();
+        __hazard_record* rec = records_.load(std::memory_order_relaxed);
+        while (rec) {
+            __hazard_record* next = rec->next;
+            delete rec;
+            rec = next;
+        }
+    }
+};
+
+// one hazard slot of the calling thread. a pointer published through protect
+// is not freed by any retire until the slot is reset or the guard dies.
+class hazard_pointer {
+private:
+    std::atomic<const void*>* slot_ = nullptr;
+    uint32_t index_ = 0;
+
+public:
+    hazard_pointer() {
+        auto& state = __hazard_registry::thread_state();
+        if (state.record == nullptr) state.record = __hazard_registry::instance().acquire_record();
+        while (index_ < __hazard_registry::SLOTS_PER_THREAD && (state.used & (1u << index_))) ++index_;
+        Exception(index_ < __hazard_registry::SLOTS_PER_THREAD,
+            MemoryError("too many hazard pointers held by one thread"));
+        state.used |= 1u << index_;
+        slot_ = &state.record->slots[index_];
+    }
+
+    hazard_pointer(const hazard_pointer&) = delete;
+    hazard_pointer& operator =(const hazard_pointer&) = delete;
+
+    ~hazard_pointer() {
+        reset();
+        __hazard_registry::thread_state().used &= ~(1u << index_);
+    }
+
+    // reads src until the published value is still current, the result is safe to dereference.
+    template <typename T>
+    T* protect(const std::atomic<T*>& src) noexcept {
+        T* ptr = src.load(std::memory_order_relaxed);
+        for (;;) {
+            slot_->store(ptr, std::memory_order_seq_cst);
+            // the reload must not pass the published slot, pairs with the fence in scan
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            T* current = src.load(std::memory_order_acquire);
+            if (current == ptr) return ptr;
+            ptr = current;
+        }
+    }
+
+    void reset() noexcept {
+        slot_->store(nullptr, std::memory_order_release);
+    }
+};
+
+template <typename T>
+void hazard_retire(T* ptr) {
+    __hazard_registry::instance().retire(ptr, &__reclaim_delete<T>);
+}
+
+inline void hazard_retire(void* ptr, void (*deleter)(void*)) {
+    __hazard_registry::instance().retire(ptr, deleter);
+}
+
+// frees what the calling thread and exited threads retired, unless still protected.
+inline void hazard_reclaim() {
+    __hazard_registry::instance().reclaim();
+}
+
+
+class __epoch_registry {
+public:
+    static constexpr uint64_t INACTIVE = ~uint64_t(0);
+
+    struct __epoch_record {
+        std::atomic<uint64_t> epoch{INACTIVE};  // epoch seen when pinned
+        std::atomic<bool> in_use{false};
+        __epoch_record* next = nullptr;
+    };
+
+private:
+    std::atomic<uint64_t> global_epoch_{0};
+    std::atomic<__epoch_record*> records_{nullptr};
+    std::mutex orphan_mtx_;
+    vector<__retired_node> orphans_;
+
+    struct __thread_state {
+        __epoch_record* record = nullptr;
+        size_t depth = 0;
+        size_t retire_count = 0;
+        vector<__retired_node> retired;
+
+        ~__thread_state() {
+            if (record == nullptr) return;
+            __epoch_registry& registry = instance();
+            registry.collect(retired);
+            if (!retired.empty()) {
+                std::lock_guard<std::mutex> lock(registry.orphan_mtx_);
+                for (const auto& node : retired) registry.orphans_.push_back(node);
+            }
+            record->in_use.store(false, std::memory_order_release);
+        }
+    };
+
+    __epoch_registry() = default;
+
+    __epoch_record* acquire_record() {
+        for (__epoch_record* rec = records_.load(std::memory_order_acquire); rec; rec = rec->next) {
+            bool expected = false;
+            if (!rec->in_use.load(std::memory_order_relaxed) &&
+                rec->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return rec;
+            }
+        }
+        auto* rec = new __epoch_record();
+        rec->in_use.store(true, std::memory_order_relaxed);
+        __epoch_record* head = records_.load(std::memory_order_relaxed);
+        do {
+            rec->next = head;
+        } while (!records_.compare_exchange_weak(head, rec, std::memory_order_release, std::memory_order_relaxed));
+        return rec;
+    }
+
+    // the epoch moves on once every pinned thread has caught up with it.
+    void try_advance() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const uint64_t current = global_epoch_.load(std::memory_order_seq_cst);
+        for (__epoch_record* rec = records_.load(std::memory_order_acquire); rec; rec = rec->next) {
+            const uint64_t seen = rec->epoch.load(std::memory_order_seq_cst);
+            if (seen != INACTIVE && seen != current) return;
+        }
+        uint64_t expected = current;
+        global_epoch_.compare_exchange_strong(expected, current + 1, std::memory_order_seq_cst);
+    }
+
+    // nodes retired two epochs ago can no longer be reached by a pinned thread.
+    void collect(vector<__retired_node>& retired) {
+        const uint64_t safe = global_epoch_.load(std::memory_order_seq_cst);
+        size_t kept = 0;
+        for (size_t i = 0; i < retired.size(); ++i) {
+            if (retired[i].epoch + 2 <= safe) {
+                retired[i].reclaim();
+            } else {
+                retired[kept++] = retired[i];
+            }
+        }
+        while (retired.size() > kept) retired.pop_back();
+    }
+
+public:
+    static constexpr size_t ADVANCE_INTERVAL = 64;
+
+    static __epoch_registry& instance() {
+        static __epoch_registry registry;
+        return registry;
+    }
+
+    static __thread_state& thread_state() {
+        static thread_local __thread_state state;
+        return state;
+    }
+
+    void pin() {
+        __thread_state& state = thread_state();
+        if (state.depth++ != 0) return;
+        if (state.record == nullptr) state.record = acquire_record();
+        // republished until the global epoch holds still across the fence, so
+        // no read of the structure can pass a stale pin
+        uint64_t epoch = global_epoch_.load(std::memory_order_relaxed);
+        for (;;) {
+            state.record->epoch.store(epoch, std::memory_order_seq_cst);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            const uint64_t current = global_epoch_.load(std::memory_order_acquire);
+            if (current == epoch) return;
+            epoch = current;
+        }
+    }
+
+    void unpin() {
+        __thread_state& state = thread_state();
+        if (--state.depth != 0) return;
+        state.record->epoch.store(INACTIVE, std::memory_order_release);
+    }
+
+    void retire(void* ptr, void (*deleter)(void*)) {
+        __thread_state& state = thread_state();
+        if (state.record == nullptr) state.record = acquire_record();
+        state.retired.push_back(__retired_node(ptr, deleter, global_epoch_.load(std::memory_order_seq_cst)));
+        if (++state.retire_count % ADVANCE_INTERVAL == 0) reclaim();
+    }
+
+    void reclaim() {
+        __thread_state& state = thread_state();
+        try_advance();
+        {
+            std::lock_guard<std::mutex> lock(orphan_mtx_);
+            if (!orphans_.empty()) {
+                for (const auto& node : orphans_) state.retired.push_back(node);
+                orphans_.clear();
+            }
+        }
+        collect(state.retired);
+    }
+
+    ~__epoch_registry() {
+        for (const auto& node : orphans_) node.reclaim();
+        __epoch_record* rec = records_.load(std::memory_order_relaxed);
+        while (rec) {
+            __epoch_record* next = rec->next;
+            delete rec;
+            rec = next;
+        }
+    }
+};
+
+// pins the calling thread to the current epoch, nodes reachable during the
+// guard's lifetime stay allocated. guards nest.
+class epoch_guard {
+public:
+    epoch_guard() {
+        __epoch_registry::instance().pin();
+    }
+    ~epoch_guard() {
+        __epoch_registry::instance().unpin();
+    }
+
+    epoch_guard(const epoch_guard&) = delete;
+    epoch_guard& operator =(const epoch_guard&) = delete;
+};
+
+template <typename T>
+void epoch_retire(T* ptr) {
+    __epoch_registry::instance().retire(ptr, &__reclaim_delete<T>);
+}
+
+inline void epoch_retire(void* ptr, void (*deleter)(void*)) {
+    __epoch_registry::instance().retire(ptr, deleter);
+}
+
+inline void epoch_reclaim() {
+    __epoch_registry::instance().reclaim();
+}
+
+MSTL_END_NAMESPACE__
+#endif // MSTL_RECLAMATION_HPP__
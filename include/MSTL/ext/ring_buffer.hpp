@@ -0,0 +1,311 @@
+#ifndef MSTL_RING_BUFFER_HPP__
+#define MSTL_RING_BUFFER_HPP__
+#include <atomic>
+#include <new>
+#include "MSTL/core/algobase.hpp"
+MSTL_BEGIN_NAMESPACE__
+
+static constexpr size_t MSTL_RING_CACHE_LINE__ = 64;
+
+// the capacity rounded up to a power of two, which must still fit in memory as cells.
+inline size_t __ring_capacity(const size_t capacity, const size_t cell_size) {
+    const size_t max_cells = ~size_t(0) / cell_size;
+    size_t max_capacity = 1;
+    while (max_capacity <= max_cells >> 1) max_capacity <<= 1;
+    Exception(capacity <= max_capacity, MemoryError("ring buffer capacity too large"));
+    size_t result = 2;
+    while (result < capacity) result <<= 1;
+    return result;
+}
+
+// bounded queue over a power of two ring, each cell carries a sequence number
+// telling whose turn it is (D. Vyukov). producers reserve cells with one CAS on
+// the enqueue index, consumers likewise on the dequeue index, or with a plain
+// store when there is a single consumer. nothing is allocated after construction.
+template <typename T, bool MultiConsumer>
+class __sequenced_ring_buffer {
+    // a claimed cell has to be handed on, or every thread after it waits for it forever
+    static_assert(is_nothrow_move_constructible_v<T> && is_nothrow_move_assignable_v<T>,
+        "ring buffer elements must be nothrow move constructible and assignable");
+
+private:
+    // one cell per cache line, neighbouring cells change hands between different threads
+    struct alignas(MSTL_RING_CACHE_LINE__) __cell {
+        std::atomic<size_t> sequence;
+        alignas(T) byte_t storage[sizeof(T)];
+
+        T* value() noexcept { return reinterpret_cast<T*>(storage); }
+    };
+
+    __cell* cells_;
+    size_t mask_;
+    alignas(MSTL_RING_CACHE_LINE__) std::atomic<size_t> enqueue_pos_{0};
+    alignas(MSTL_RING_CACHE_LINE__) std::atomic<size_t> dequeue_pos_{0};
+
+    static bool is_behind(const size_t sequence, const size_t expected) noexcept {
+        return static_cast<ptrdiff_t>(sequence - expected) < 0;
+    }
+
+    // claims up to n consecutive free cells starting at pos, 0 when full.
+    size_t reserve_push(const size_t n, size_t& pos) {
+        pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t ready = 0;
+            size_t sequence = 0;
+            while (ready < n) {
+                sequence = cells_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire);
+                if (sequence != pos + ready) break;
+                ++ready;
+            }
+            if (ready == 0) {
+                if (is_behind(sequence, pos)) return 0;
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if (enqueue_pos_.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+                return ready;
+        }
+    }
+
+    // claims up to n consecutive filled cells starting at pos, 0 when empty.
+    size_t reserve_pop(const size_t n, size_t& pos) {
+        pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            size_t ready = 0;
+            size_t sequence = 0;
+            while (ready < n) {
+                sequence = cells_[(pos + ready) & mask_].sequence.load(std::memory_order_acquire);
+                if (sequence != pos + ready + 1) break;
+                ++ready;
+            }
+            if (ready == 0) {
+                if (is_behind(sequence, pos + 1)) return 0;
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+                continue;
+            }
+            if constexpr (!MultiConsumer) {
+                dequeue_pos_.store(pos + ready, std::memory_order_relaxed);
+                return ready;
+            }
+            if (dequeue_pos_.compare_exchange_weak(pos, pos + ready, std::memory_order_relaxed))
+                return ready;
+        }
+    }
+
+    template <typename... Args>
+    void publish(const size_t pos, Args&&... args) noexcept {
+        static_assert(is_nothrow_constructible_v<T, Args&&...>, "publish must not throw");
+        __cell& cell = cells_[pos & mask_];
+        ::new(static_cast<void*>(cell.storage)) T(_MSTL forward<Args>(args)...);
+        cell.sequence.store(pos + 1, std::memory_order_release);
+    }
+
+    void release(const size_t pos, T& out) noexcept {
+        __cell& cell = cells_[pos & mask_];
+        out = _MSTL move(*cell.value());
+        cell.value()->~T();
+        cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+    }
+
+public:
+    explicit __sequenced_ring_buffer(const size_t capacity) : mask_(__ring_capacity(capacity, sizeof(__cell)) - 1) {
+        cells_ = static_cast<__cell*>(::operator new(sizeof(__cell) * (mask_ + 1),
+            std::align_val_t{alignof(__cell)}));
+        for (size_t i = 0; i <= mask_; ++i) {
+            ::new(static_cast<void*>(&cells_[i].sequence)) std::atomic<size_t>(i);
+        }
+    }
+
+    __sequenced_ring_buffer(const __sequenced_ring_buffer&) = delete;
+    __sequenced_ring_buffer& operator =(const __sequenced_ring_buffer&) = delete;
+
+    ~__sequenced_ring_buffer() {
+        const size_t last = enqueue_pos_.load(std::memory_order_relaxed);
+        for (size_t pos = dequeue_pos_.load(std::memory_order_relaxed); pos != last; ++pos) {
+            __cell& cell = cells_[pos & mask_];
+            if (cell.sequence.load(std::memory_order_relaxed) == pos + 1) cell.value()->~T();
+        }
+        ::operator delete(cells_, std::align_val_t{alignof(__cell)});
+    }
+
+    // a constructor that may throw runs on a temporary before any cell is claimed.
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        size_t pos;
+        if constexpr (is_nothrow_constructible_v<T, Args&&...>) {
+            if (reserve_push(1, pos) == 0) return false;
+            publish(pos, _MSTL forward<Args>(args)...);
+        } else {
+            T value(_MSTL forward<Args>(args)...);
+            if (reserve_push(1, pos) == 0) return false;
+            publish(pos, _MSTL move(value));
+        }
+        return true;
+    }
+
+    bool try_push(const T& value) { return try_emplace(value); }
+    bool try_push(T&& value) { return try_emplace(_MSTL move(value)); }
+
+    bool try_pop(T& out) {
+        size_t pos;
+        if (reserve_pop(1, pos) == 0) return false;
+        release(pos, out);
+        return true;
+    }
+
+    // copies up to n elements from first with a single reservation, returns how many went in.
+    // elements whose copy may throw are pushed one at a time instead.
+    template <typename Iterator>
+    size_t push_n(Iterator first, const size_t n) {
+        if constexpr (is_nothrow_constructible_v<T, decltype(*first)>) {
+            size_t pos;
+            const size_t count = reserve_push(n, pos);
+            for (size_t i = 0; i < count; ++i, ++first) {
+                publish(pos + i, *first);
+            }
+            return count;
+        } else {
+            size_t count = 0;
+            for (; count < n && try_emplace(*first); ++count, ++first) {}
+            return count;
+        }
+    }
+
+    template <typename Iterator>
+    size_t pop_n(Iterator out, const size_t n) {
+        size_t pos;
+        const size_t count = reserve_pop(n, pos);
+        for (size_t i = 0; i < count; ++i, ++out) {
+            release(pos + i, *out);
+        }
+        return count;
+    }
+
+    MSTL_NODISCARD size_t capacity() const noexcept { return mask_ + 1; }
+
+    // exact only while no other thread is pushing or popping.
+    MSTL_NODISCARD size_t size() const noexcept {
+        const size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        const size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        return tail - head;
+    }
+    MSTL_NODISCARD bool empty() const noexcept { return size() == 0; }
+};
+
+template <typename T>
+using mpmc_ring_buffer = __sequenced_ring_buffer<T, true>;
+
+// several producers, pop and pop_n only from one thread at a time.
+template <typename T>
+using mpsc_ring_buffer = __sequenced_ring_buffer<T, false>;
+
+
+// one producer thread, one consumer thread. each side owns its index and keeps
+// a cached copy of the other one, so the shared line is only read when the
+// cached view says full or empty.
+template <typename T>
+class spsc_ring_buffer {
+private:
+    struct __slot {
+        alignas(T) byte_t storage[sizeof(T)];
+
+        T* value() noexcept { return reinterpret_cast<T*>(storage); }
+    };
+
+    __slot* slots_;
+    size_t mask_;
+    alignas(MSTL_RING_CACHE_LINE__) std::atomic<size_t> head_{0};  // consumer
+    size_t cached_tail_ = 0;
+    alignas(MSTL_RING_CACHE_LINE__) std::atomic<size_t> tail_{0};  // producer
+    size_t cached_head_ = 0;
+
+    size_t writable(const size_t tail, const size_t n) {
+        size_t free = mask_ + 1 - (tail - cached_head_);
+        if (free < n) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            free = mask_ + 1 - (tail - cached_head_);
+        }
+        return _MSTL min(free, n);
+    }
+
+    size_t readable(const size_t head, const size_t n) {
+        size_t filled = cached_tail_ - head;
+        if (filled < n) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            filled = cached_tail_ - head;
+        }
+        return _MSTL min(filled, n);
+    }
+
+public:
+    explicit spsc_ring_buffer(const size_t capacity) : mask_(__ring_capacity(capacity, sizeof(__slot)) - 1) {
+        slots_ = static_cast<__slot*>(::operator new(sizeof(__slot) * (mask_ + 1)));
+    }
+
+    spsc_ring_buffer(const spsc_ring_buffer&) = delete;
+    spsc_ring_buffer& operator =(const spsc_ring_buffer&) = delete;
+
+    ~spsc_ring_buffer() {
+        const size_t last = tail_.load(std::memory_order_relaxed);
+        for (size_t pos = head_.load(std::memory_order_relaxed); pos != last; ++pos) {
+            slots_[pos & mask_].value()->~T();
+        }
+        ::operator delete(slots_);
+    }
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (writable(tail, 1) == 0) return false;
+        ::new(static_cast<void*>(slots_[tail & mask_].storage)) T(_MSTL forward<Args>(args)...);
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const T& value) { return try_emplace(value); }
+    bool try_push(T&& value) { return try_emplace(_MSTL move(value)); }
+
+    bool try_pop(T& out) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (readable(head, 1) == 0) return false;
+        T* value = slots_[head & mask_].value();
+        out = _MSTL move(*value);
+        value->~T();
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Iterator>
+    size_t push_n(Iterator first, const size_t n) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        const size_t count = writable(tail, n);
+        for (size_t i = 0; i < count; ++i, ++first) {
+            ::new(static_cast<void*>(slots_[(tail + i) & mask_].storage)) T(*first);
+        }
+        tail_.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    template <typename Iterator>
+    size_t pop_n(Iterator out, const size_t n) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        const size_t count = readable(head, n);
+        for (size_t i = 0; i < count; ++i, ++out) {
+            T* value = slots_[(head + i) & mask_].value();
+            *out = _MSTL move(*value);
+            value->~T();
+        }
+        head_.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    MSTL_NODISCARD size_t capacity() const noexcept { return mask_ + 1; }
+
+    MSTL_NODISCARD size_t size() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+    MSTL_NODISCARD bool empty() const noexcept { return size() == 0; }
+};
+
+MSTL_END_NAMESPACE__
+#endif // MSTL_RING_BUFFER_HPP__
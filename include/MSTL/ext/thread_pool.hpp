@@ -9,15 +9,58 @@
 #include "MSTL/core/queue.hpp"
 #include "MSTL/core/functional.hpp"
 #include "MSTL/core/unordered_map.hpp"
+#include "MSTL/core/vector.hpp"
+#include "MSTL/core/memory.hpp"
 MSTL_BEGIN_NAMESPACE__
 
 static constexpr size_t MSTL_TASK_MAX_THRESHHOLD__ = INT32_MAX_SIZE;
 static const size_t MSTL_THREAD_MAX_THRESHHOLD__ = std::thread::hardware_concurrency();
 static constexpr int64_t MSTL_THREAD_MAX_IDLE_SECONDS__ = 60;
 
+MSTL_ERROR_BUILD_DERIVED_CLASS(ThreadPoolError, Error, "Thread Pool Operation Failed.")
+MSTL_ERROR_BUILD_FINAL_CLASS(TaskRejectedError, ThreadPoolError, "Task Rejected by a Full Thread Pool.")
+MSTL_ERROR_BUILD_FINAL_CLASS(TaskExpiredError, ThreadPoolError, "Task Deadline Passed in Queue.")
+
 enum class THREAD_POOL_MODE {
-	MODE_FIXED,  // static number
-	MODE_CACHED  // dynamic number
+	MODE_FIXED,   // static number
+	MODE_CACHED,  // dynamic number
+	MODE_STEALING // static number, per thread deques with work stealing
+};
+
+// queued tasks of a higher priority run first.
+enum class TASK_PRIORITY {
+	HIGH, NORMAL, LOW
+};
+
+// what a submit does when the task queue is full.
+enum class FULL_POLICY {
+	BLOCK,       // wait for room up to the block timeout, then reject
+	REJECT,      // fail at once
+	CALLER_RUNS  // run the task on the submitting thread
+};
+
+struct task_option {
+	using clock_type = std::chrono::steady_clock;
+
+	TASK_PRIORITY priority = TASK_PRIORITY::NORMAL;
+	// a task still queued at its deadline is not run, its future fails with TaskExpiredError.
+	clock_type::time_point deadline = clock_type::time_point::max();
+
+	task_option() = default;
+	task_option(const TASK_PRIORITY priority) noexcept : priority(priority) {}
+	task_option(const TASK_PRIORITY priority, const clock_type::time_point deadline) noexcept
+		: priority(priority), deadline(deadline) {}
+
+	template <typename Rep, typename Period>
+	static task_option within(const std::chrono::duration<Rep, Period>& timeout,
+		const TASK_PRIORITY priority = TASK_PRIORITY::NORMAL) {
+		return task_option(priority, clock_type::now()
+			+ std::chrono::duration_cast<clock_type::duration>(timeout));
+	}
+
+	MSTL_NODISCARD bool expired() const {
+		return deadline != clock_type::time_point::max() && clock_type::now() >= deadline;
+	}
 };
 
 class manual_thread;
@@ -122,6 +165,354 @@ public:
 #endif
 
 
+// thread local free lists of small blocks, used for boxed tasks and future states.
+// a full list passes a batch to a shared depot and an empty one takes a batch back,
+// so blocks freed by workers return to the threads that submit.
+struct __task_block_pool {
+private:
+    static constexpr size_t GRANULE = 64;
+    static constexpr size_t CLASS_COUNT = 4;  // blocks of 64, 128, 192 and 256 bytes
+    static constexpr size_t MAX_CACHED = 256;
+    static constexpr size_t BATCH_SIZE = 64;
+    static constexpr size_t MAX_DEPOT_BATCHES = 64;
+
+    struct __free_block {
+        __free_block* next;
+        __free_block* next_batch;  // links the batches kept in the depot
+    };
+
+    struct __block_depot {
+        std::mutex mtx;
+        __free_block* batches[CLASS_COUNT] = {};
+        size_t counts[CLASS_COUNT] = {};
+    };
+
+    struct __block_cache {
+        __free_block* heads[CLASS_COUNT] = {};
+        size_t counts[CLASS_COUNT] = {};
+
+        ~__block_cache();
+    };
+
+    // never destroyed, detached threads may still free blocks during exit
+    static __block_depot& depot() {
+        static __block_depot* const depot = new __block_depot();
+        return *depot;
+    }
+
+    // trivially destructible, so still readable once the cache is gone.
+    // states released during thread teardown bypass the lists.
+    static bool& cache_destroyed() noexcept {
+        static thread_local bool destroyed = false;
+        return destroyed;
+    }
+
+    static __block_cache& cache() {
+        static thread_local __block_cache cache;
+        return cache;
+    }
+
+    static void delete_list(__free_block* head) noexcept {
+        while (head) {
+            __free_block* next = head->next;
+            ::operator delete(head);
+            head = next;
+        }
+    }
+
+    static bool take_batch(__block_cache& blocks, const size_t index) {
+        __block_depot& shared = depot();
+        std::lock_guard<std::mutex> lock(shared.mtx);
+        __free_block* batch = shared.batches[index];
+        if (!batch) return false;
+        shared.batches[index] = batch->next_batch;
+        --shared.counts[index];
+        blocks.heads[index] = batch;
+        blocks.counts[index] = BATCH_SIZE;
+        return true;
+    }
+
+    // moves BATCH_SIZE blocks off the front of the list into the depot.
+    static void give_batch(__block_cache& blocks, const size_t index) noexcept {
+        __free_block* batch = blocks.heads[index];
+        __free_block* last = batch;
+        for (size_t i = 1; i < BATCH_SIZE; ++i) last = last->next;
+        blocks.heads[index] = last->next;
+        blocks.counts[index] -= BATCH_SIZE;
+        last->next = nullptr;
+        {
+            __block_depot& shared = depot();
+            std::lock_guard<std::mutex> lock(shared.mtx);
+            if (shared.counts[index] < MAX_DEPOT_BATCHES) {
+                batch->next_batch = shared.batches[index];
+                shared.batches[index] = batch;
+                ++shared.counts[index];
+                return;
+            }
+        }
+        delete_list(batch);
+    }
+
+public:
+    static void* allocate(const size_t size) {
+        if (size > GRANULE * CLASS_COUNT) return ::operator new(size);
+        const size_t index = (size - 1) / GRANULE;
+        if (cache_destroyed()) return ::operator new((index + 1) * GRANULE);
+        __block_cache& blocks = cache();
+        if (blocks.heads[index] || take_batch(blocks, index)) {
+            __free_block* block = blocks.heads[index];
+            blocks.heads[index] = block->next;
+            --blocks.counts[index];
+            return block;
+        }
+        return ::operator new((index + 1) * GRANULE);
+    }
+
+    static void deallocate(void* ptr, const size_t size) noexcept {
+        if (size > GRANULE * CLASS_COUNT || cache_destroyed()) {
+            ::operator delete(ptr);
+            return;
+        }
+        const size_t index = (size - 1) / GRANULE;
+        __block_cache& blocks = cache();
+        if (blocks.counts[index] >= MAX_CACHED) give_batch(blocks, index);
+        auto* block = static_cast<__free_block*>(ptr);
+        block->next = blocks.heads[index];
+        blocks.heads[index] = block;
+        ++blocks.counts[index];
+    }
+};
+
+inline __task_block_pool::__block_cache::~__block_cache() {
+    cache_destroyed() = true;
+    for (size_t i = 0; i < CLASS_COUNT; ++i) {
+        while (counts[i] >= BATCH_SIZE) give_batch(*this, i);
+        delete_list(heads[i]);
+        heads[i] = nullptr;
+        counts[i] = 0;
+    }
+}
+
+// hands the shared states of submitted tasks' futures out of __task_block_pool.
+template <typename T>
+struct __task_state_allocator {
+    using value_type = T;
+
+    __task_state_allocator() noexcept = default;
+    template <typename U>
+    __task_state_allocator(const __task_state_allocator<U>&) noexcept {}
+
+    T* allocate(const size_t n) {
+        return static_cast<T*>(__task_block_pool::allocate(n * sizeof(T)));
+    }
+    void deallocate(T* ptr, const size_t n) noexcept {
+        __task_block_pool::deallocate(ptr, n * sizeof(T));
+    }
+
+    template <typename U>
+    bool operator ==(const __task_state_allocator<U>&) const noexcept { return true; }
+    template <typename U>
+    bool operator !=(const __task_state_allocator<U>&) const noexcept { return false; }
+};
+
+
+// move only void() callable. targets up to INLINE_SIZE bytes live inside the
+// object, so wrapping a small lambda does not allocate.
+class __thread_pool_task {
+private:
+    static constexpr size_t INLINE_SIZE = 64;
+
+    using invoke_type = void (*)(void*);
+    using relocate_type = void (*)(void* dest, void* src);  // dest null only destroys
+
+    template <typename F>
+    struct __inline_ops {
+        static void invoke(void* target) {
+            (*static_cast<F*>(target))();
+        }
+        static void relocate(void* dest, void* src) {
+            F* from = static_cast<F*>(src);
+            if (dest) ::new(dest) F(_MSTL move(*from));
+            from->~F();
+        }
+    };
+
+    template <typename F>
+    struct __heap_ops {
+        static void invoke(void* target) {
+            (**static_cast<F**>(target))();
+        }
+        static void relocate(void* dest, void* src) {
+            if (dest) *static_cast<F**>(dest) = *static_cast<F**>(src);
+            else delete *static_cast<F**>(src);
+        }
+    };
+
+    alignas(max_align_t) byte_t storage_[INLINE_SIZE];
+    invoke_type invoke_ = nullptr;
+    relocate_type relocate_ = nullptr;
+
+public:
+    __thread_pool_task() noexcept = default;
+    __thread_pool_task(nullptr_t) noexcept {}
+
+    template <typename F, typename Fn = decay_t<F>,
+        enable_if_t<!is_same_v<Fn, __thread_pool_task> && is_invocable_v<Fn&>, int> = 0>
+    __thread_pool_task(F&& f) {
+        if constexpr (sizeof(Fn) <= INLINE_SIZE && alignof(Fn) <= alignof(max_align_t)
+            && is_nothrow_move_constructible_v<Fn>) {
+            ::new(static_cast<void*>(storage_)) Fn(_MSTL forward<F>(f));
+            invoke_ = &__inline_ops<Fn>::invoke;
+            relocate_ = &__inline_ops<Fn>::relocate;
+        } else {
+            ::new(static_cast<void*>(storage_)) Fn*(new Fn(_MSTL forward<F>(f)));
+            invoke_ = &__heap_ops<Fn>::invoke;
+            relocate_ = &__heap_ops<Fn>::relocate;
+        }
+    }
+
+    __thread_pool_task(__thread_pool_task&& other) noexcept
+    : invoke_(other.invoke_), relocate_(other.relocate_) {
+        if (relocate_) relocate_(storage_, other.storage_);
+        other.invoke_ = nullptr;
+        other.relocate_ = nullptr;
+    }
+
+    __thread_pool_task& operator =(__thread_pool_task&& other) noexcept {
+        if (this == &other) return *this;
+        if (relocate_) relocate_(nullptr, storage_);
+        invoke_ = other.invoke_;
+        relocate_ = other.relocate_;
+        if (relocate_) relocate_(storage_, other.storage_);
+        other.invoke_ = nullptr;
+        other.relocate_ = nullptr;
+        return *this;
+    }
+
+    __thread_pool_task(const __thread_pool_task&) = delete;
+    __thread_pool_task& operator =(const __thread_pool_task&) = delete;
+
+    ~__thread_pool_task() {
+        if (relocate_) relocate_(nullptr, storage_);
+    }
+
+    explicit operator bool() const noexcept {
+        return invoke_ != nullptr;
+    }
+
+    void operator ()() {
+        invoke_(storage_);
+    }
+};
+
+
+// Chase-Lev deque of task pointers. the owning thread pushes and pops at the
+// bottom without locking, other threads steal from the top with one CAS.
+// grown buffers are retired rather than freed, a thief may still read them.
+template <typename T>
+class __work_stealing_deque {
+private:
+    struct __buffer {
+        int64_t capacity;
+        std::atomic<T*>* slots;
+
+        explicit __buffer(const int64_t capacity)
+        : capacity(capacity), slots(new std::atomic<T*>[capacity]) {}
+
+        ~__buffer() {
+            delete[] slots;
+        }
+
+        T* get(const int64_t index) const noexcept {
+            return slots[index & (capacity - 1)].load(std::memory_order_relaxed);
+        }
+        void put(const int64_t index, T* value) noexcept {
+            slots[index & (capacity - 1)].store(value, std::memory_order_relaxed);
+        }
+    };
+
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    std::atomic<__buffer*> buffer_;
+    _MSTL vector<_MSTL unique_ptr<__buffer>> buffers_;
+
+    __buffer* grow(__buffer* old, const int64_t bottom, const int64_t top) {
+        auto bigger = _MSTL make_unique<__buffer>(old->capacity * 2);
+        for (int64_t i = top; i < bottom; ++i) {
+            bigger->put(i, old->get(i));
+        }
+        __buffer* raw = bigger.get();
+        buffers_.push_back(_MSTL move(bigger));
+        buffer_.store(raw, std::memory_order_release);
+        return raw;
+    }
+
+public:
+    explicit __work_stealing_deque(const int64_t capacity = 256) {
+        buffers_.push_back(_MSTL make_unique<__buffer>(capacity));
+        buffer_.store(buffers_.back().get(), std::memory_order_relaxed);
+    }
+
+    __work_stealing_deque(const __work_stealing_deque&) = delete;
+    __work_stealing_deque& operator =(const __work_stealing_deque&) = delete;
+
+    // owner only.
+    void push(T* value) {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed);
+        const int64_t top = top_.load(std::memory_order_acquire);
+        __buffer* buffer = buffer_.load(std::memory_order_relaxed);
+        if (bottom - top > buffer->capacity - 1) {
+            buffer = grow(buffer, bottom, top);
+        }
+        buffer->put(bottom, value);
+        bottom_.store(bottom + 1, std::memory_order_release);
+    }
+
+    // owner only, newest first.
+    T* pop() {
+        const int64_t bottom = bottom_.load(std::memory_order_relaxed) - 1;
+        __buffer* buffer = buffer_.load(std::memory_order_relaxed);
+        bottom_.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t top = top_.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T* value = buffer->get(bottom);
+        if (top == bottom) {
+            // last element, race the thieves for it
+            if (!top_.compare_exchange_strong(top, top + 1,
+                std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                value = nullptr;
+            }
+            bottom_.store(bottom + 1, std::memory_order_relaxed);
+        }
+        return value;
+    }
+
+    // any thread, oldest first. null when empty or when another thief won.
+    T* steal() {
+        int64_t top = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t bottom = bottom_.load(std::memory_order_acquire);
+        if (top >= bottom) return nullptr;
+
+        T* value = buffer_.load(std::memory_order_acquire)->get(top);
+        if (!top_.compare_exchange_strong(top, top + 1,
+            std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return value;
+    }
+
+    MSTL_NODISCARD bool empty() const noexcept {
+        return top_.load(std::memory_order_relaxed) >= bottom_.load(std::memory_order_relaxed);
+    }
+};
+
+
 class manual_thread {
 public:
     using id_type = uint32_t;
@@ -155,14 +546,22 @@ public:
     using id_type = manual_thread::id_type;
 
 private:
-	using Task = _MSTL function<void()>;
+	using Task = __thread_pool_task;
 
 	_MSTL unordered_map<id_type, _MSTL unique_ptr<manual_thread>> threads_map_;
 
 	id_type init_thread_size_;
 	size_t thread_threshhold_;
 
-	_MSTL queue<Task> task_queue_;
+	static constexpr size_t PRIORITY_COUNT = 3;
+	static constexpr size_t STARVATION_LIMIT = 16;
+
+	// one lane per priority, tasks are boxed since the queue needs copyable elements
+	_MSTL queue<Task*> task_queues_[PRIORITY_COUNT];
+	size_t passed_over_[PRIORITY_COUNT] = {};
+	std::atomic_uint urgent_size_{0};  // queued HIGH tasks
+	FULL_POLICY full_policy_ = FULL_POLICY::BLOCK;
+	std::chrono::milliseconds block_timeout_{1000};
 	std::atomic_uint task_size_;
 	std::atomic_uint idle_thread_size_;
 	size_t task_threshhold_;
@@ -175,9 +574,167 @@ private:
 	std::atomic<THREAD_POOL_MODE> pool_mode_;
 	std::atomic_bool is_running_;
 
+	struct __stealing_worker {
+		__work_stealing_deque<Task> deque;
+		uint32_t seed = 0;
+	};
+
+	struct __stealing_context {
+		thread_pool* pool = nullptr;
+		__stealing_worker* worker = nullptr;
+	};
+
+	_MSTL vector<_MSTL unique_ptr<__stealing_worker>> workers_;
+	std::atomic_uint sleeping_size_{0};
+
     friend thread_pool& get_instance_thread_pool();
 
 private:
+    // queues hold pointers, tasks are moved into pooled blocks on the way in.
+    static Task* box(Task task) {
+        return ::new(__task_block_pool::allocate(sizeof(Task))) Task(_MSTL move(task));
+    }
+    static Task unbox(Task* boxed) {
+        Task task(_MSTL move(*boxed));
+        boxed->~Task();
+        __task_block_pool::deallocate(boxed, sizeof(Task));
+        return task;
+    }
+
+    bool queued_empty() const noexcept {
+        for (const auto& lane : task_queues_) {
+            if (!lane.empty()) return false;
+        }
+        return true;
+    }
+
+    void push_queued(Task* task, const TASK_PRIORITY priority) {
+        task_queues_[static_cast<size_t>(priority)].push(task);
+        if (priority == TASK_PRIORITY::HIGH) ++urgent_size_;
+    }
+
+    // the highest non-empty lane, unless a lower one was passed over
+    // STARVATION_LIMIT times in a row. the queue lock must be held.
+    Task* pop_queued() {
+        size_t lane = PRIORITY_COUNT;
+        for (size_t i = PRIORITY_COUNT; i-- > 1;) {
+            if (!task_queues_[i].empty() && passed_over_[i] >= STARVATION_LIMIT) {
+                lane = i;
+                break;
+            }
+        }
+        for (size_t i = 0; lane == PRIORITY_COUNT && i < PRIORITY_COUNT; ++i) {
+            if (!task_queues_[i].empty()) lane = i;
+        }
+        if (lane == PRIORITY_COUNT) return nullptr;
+
+        for (size_t i = lane + 1; i < PRIORITY_COUNT; ++i) {
+            if (!task_queues_[i].empty()) ++passed_over_[i];
+        }
+        passed_over_[lane] = 0;
+        if (lane == 0) --urgent_size_;
+        Task* task = task_queues_[lane].front();
+        task_queues_[lane].pop();
+        return task;
+    }
+
+    static __stealing_context& current_context() {
+        static thread_local __stealing_context context;
+        return context;
+    }
+
+    // takes queued HIGH tasks first, then the worker's own deque, then the
+    // injection lanes, then steals from the other workers starting at a random victim.
+    bool find_task(__stealing_worker& self, Task& task) {
+        if (urgent_size_ > 0) {
+            std::lock_guard<std::mutex> lock(task_queue_mtx_);
+            if (Task* urgent = pop_queued()) {
+                task = unbox(urgent);
+                return true;
+            }
+        }
+        if (Task* local = self.deque.pop()) {
+            task = unbox(local);
+            return true;
+        }
+        {
+            std::lock_guard<std::mutex> lock(task_queue_mtx_);
+            if (Task* queued = pop_queued()) {
+                task = unbox(queued);
+                return true;
+            }
+        }
+
+        const size_t count = workers_.size();
+        self.seed ^= self.seed << 13;
+        self.seed ^= self.seed >> 17;
+        self.seed ^= self.seed << 5;
+        const size_t start = self.seed % count;
+        for (size_t i = 0; i < count; ++i) {
+            __stealing_worker& victim = *workers_[(start + i) % count];
+            if (&victim == &self) continue;
+            if (Task* stolen = victim.deque.steal()) {
+                task = unbox(stolen);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void stealing_function(const id_type thread_id, const size_t index) {
+        __stealing_worker& self = *workers_[index];
+        current_context() = {this, &self};
+
+        for (;;) {
+            Task task{};
+            if (find_task(self, task)) {
+                if (task_size_.fetch_sub(1) == task_threshhold_) {
+                    // under the lock, or a submitter between its check and its wait misses it
+                    std::lock_guard<std::mutex> lock(task_queue_mtx_);
+                    not_full_.notify_all();
+                }
+                if (task) task();
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(task_queue_mtx_);
+            // announce sleeping before the last look, a submitter that misses
+            // the announcement has published its task before this check
+            ++sleeping_size_;
+            if (task_size_ > 0) {
+                --sleeping_size_;
+                continue;
+            }
+            if (!is_running_) {
+                --sleeping_size_;
+                current_context() = {};
+                threads_map_.erase(thread_id);
+                exit_cond_.notify_all();
+                return;
+            }
+            not_empty_.wait(lock);
+            --sleeping_size_;
+        }
+    }
+
+    // NORMAL tasks of a worker stay on its deque, the rest go through the lanes.
+    void submit_stealing(Task task, const TASK_PRIORITY priority) {
+        __stealing_context& context = current_context();
+        if (context.pool == this && priority == TASK_PRIORITY::NORMAL) {
+            context.worker->deque.push(box(_MSTL move(task)));
+            ++task_size_;
+        } else {
+            std::lock_guard<std::mutex> lock(task_queue_mtx_);
+            push_queued(box(_MSTL move(task)), priority);
+            ++task_size_;
+        }
+        // wake exactly one sleeper, and only if there is one
+        if (sleeping_size_ > 0) {
+            std::lock_guard<std::mutex> lock(task_queue_mtx_);
+            not_empty_.notify_one();
+        }
+    }
+
     void thread_function(const id_type thread_id) {
         auto last = std::chrono::high_resolution_clock::now();
 
@@ -185,7 +742,7 @@ private:
             Task task{};
             {
                 std::unique_lock<std::mutex> lock(task_queue_mtx_);
-                while (task_queue_.empty()) {
+                while (queued_empty()) {
                     if (!is_running_) {
                         threads_map_.erase(thread_id);
                         exit_cond_.notify_all();
@@ -208,13 +765,12 @@ private:
                 }
 
                 --idle_thread_size_;
-                task = task_queue_.front();
-                task_queue_.pop();
+                task = unbox(pop_queued());
                 --task_size_;
-                if (!task_queue_.empty()) not_empty_.notify_all();
+                if (!queued_empty()) not_empty_.notify_all();
                 not_full_.notify_all();
             }
-            if (task != nullptr) task();
+            if (task) task();
             ++idle_thread_size_;
             last = std::chrono::high_resolution_clock::now();
         }
@@ -253,12 +809,21 @@ public:
     }
 
     bool set_thread_threshhold(const size_t threshhold) {
-        if (is_running_ || pool_mode_ == THREAD_POOL_MODE::MODE_FIXED) return false;
+        if (is_running_ || pool_mode_ != THREAD_POOL_MODE::MODE_CACHED) return false;
         thread_threshhold_ = threshhold > MSTL_THREAD_MAX_THRESHHOLD__
             ? MSTL_THREAD_MAX_THRESHHOLD__ : threshhold;
         return true;
     }
 
+    // timeout only applies to FULL_POLICY::BLOCK.
+    bool set_full_policy(const FULL_POLICY policy,
+        const std::chrono::milliseconds timeout = std::chrono::milliseconds(1000)) {
+        if (is_running_) return false;
+        full_policy_ = policy;
+        block_timeout_ = timeout;
+        return true;
+    }
+
     MSTL_NODISCARD static size_t max_thread_size() noexcept {
         return MSTL_THREAD_MAX_THRESHHOLD__;
     }
@@ -273,9 +838,22 @@ public:
         if(is_running_) return false;
         is_running_ = true;
         init_thread_size_ = init_thread_size;
-        for (id_type i = 0; i < init_thread_size_; i++) {
-            auto ptr = _MSTL make_unique<manual_thread>([this](const int id) { thread_function(id); });
-            threads_map_.emplace(ptr->get_id(), _MSTL move(ptr));
+        if (pool_mode_ == THREAD_POOL_MODE::MODE_STEALING) {
+            for (id_type i = 0; i < init_thread_size_; i++) {
+                auto worker = _MSTL make_unique<__stealing_worker>();
+                worker->seed = 0x9e3779b9u * (i + 1);
+                workers_.push_back(_MSTL move(worker));
+            }
+            for (id_type i = 0; i < init_thread_size_; i++) {
+                auto ptr = _MSTL make_unique<manual_thread>(
+                    [this, i](const id_type id) { stealing_function(id, i); });
+                threads_map_.emplace(ptr->get_id(), _MSTL move(ptr));
+            }
+        } else {
+            for (id_type i = 0; i < init_thread_size_; i++) {
+                auto ptr = _MSTL make_unique<manual_thread>([this](const int id) { thread_function(id); });
+                threads_map_.emplace(ptr->get_id(), _MSTL move(ptr));
+            }
         }
         for (id_type i = 0; i < init_thread_size_; i++) {
             threads_map_[i]->start();
@@ -290,27 +868,108 @@ public:
         std::unique_lock<std::mutex> lock(task_queue_mtx_);
         not_empty_.notify_all();
         exit_cond_.wait(lock, [&]()->bool { return threads_map_.empty(); });
+        workers_.clear();
         __thread_pool_id_generator::reset_id();
     }
 
 	template <typename Func, typename... Args, enable_if_t<is_invocable_v<Func, Args...>, int> = 0>
 	decltype(auto) submit_task(Func&& func, Args&&... args) {
+		return submit_task(task_option(), _MSTL forward<Func>(func), _MSTL forward<Args>(args)...);
+	}
+
+	// the future fails with TaskRejectedError when the full policy refuses the
+	// task and with TaskExpiredError when its deadline passes in the queue.
+	template <typename Func, typename... Args, enable_if_t<is_invocable_v<Func, Args...>, int> = 0>
+	decltype(auto) submit_task(const task_option& option, Func&& func, Args&&... args) {
 		using Result = decltype(func(_MSTL forward<Args>(args)...));
-		auto task = _MSTL make_shared<std::packaged_task<Result()>>(
-			[func = _MSTL forward<Func>(func), args = _MSTL make_tuple(_MSTL forward<Args>(args)...)]() mutable {
-				return _MSTL apply(func, args);
+		std::promise<Result> promise(std::allocator_arg, __task_state_allocator<Result>());
+		std::future<Result> res = promise.get_future();
+
+		Task task([promise = _MSTL move(promise), func = _MSTL forward<Func>(func),
+			args = _MSTL make_tuple(_MSTL forward<Args>(args)...), option]() mutable {
+			if (option.expired()) {
+				promise.set_exception(std::make_exception_ptr(TaskExpiredError()));
+				return;
 			}
-		);
-		std::future<Result> res = task->get_future();
+			fulfil(promise, func, args);
+		});
+		if (!enqueue(task, option.priority)) {
+			std::promise<Result> rejected;
+			rejected.set_exception(std::make_exception_ptr(TaskRejectedError()));
+			return rejected.get_future();
+		}
+		return res;
+	}
+
+	// fire and forget, nothing waits for the outcome and exceptions are dropped.
+	// false when the task was refused because the queue stayed full.
+	template <typename Func, typename... Args, enable_if_t<is_invocable_v<Func, Args...>, int> = 0>
+	bool post(Func&& func, Args&&... args) {
+		return post(task_option(), _MSTL forward<Func>(func), _MSTL forward<Args>(args)...);
+	}
+
+	// an expired task is dropped without running.
+	template <typename Func, typename... Args, enable_if_t<is_invocable_v<Func, Args...>, int> = 0>
+	bool post(const task_option& option, Func&& func, Args&&... args) {
+		Task task([func = _MSTL forward<Func>(func),
+			args = _MSTL make_tuple(_MSTL forward<Args>(args)...), option]() mutable {
+			if (option.expired()) return;
+			try {
+				_MSTL apply(func, args);
+			} catch (...) {}
+		});
+		return enqueue(task, option.priority);
+	}
+
+private:
+	template <typename Result, typename Func, typename Tuple, enable_if_t<!is_void_v<Result>, int> = 0>
+	static void fulfil(std::promise<Result>& promise, Func& func, Tuple& args) {
+		try {
+			promise.set_value(_MSTL apply(func, args));
+		} catch (...) {
+			promise.set_exception(std::current_exception());
+		}
+	}
+	template <typename Result, typename Func, typename Tuple, enable_if_t<is_void_v<Result>, int> = 0>
+	static void fulfil(std::promise<Result>& promise, Func& func, Tuple& args) {
+		try {
+			_MSTL apply(func, args);
+			promise.set_value();
+		} catch (...) {
+			promise.set_exception(std::current_exception());
+		}
+	}
+
+	// room in the queue per the full policy, the lock is held on success.
+	// CALLER_RUNS reports false as well, the caller then runs the task itself.
+	bool wait_room(std::unique_lock<std::mutex>& lock) {
+		const auto has_room = [&]()->bool { return task_size_ < task_threshhold_; };
+		if (has_room()) return true;
+		if (full_policy_ != FULL_POLICY::BLOCK) return false;
+		return not_full_.wait_for(lock, block_timeout_, has_room);
+	}
+
+	// moves the task into the pool. when the queue is full the full policy
+	// decides, false means the task was refused and is left untouched.
+	bool enqueue(Task& task, const TASK_PRIORITY priority) {
+		if (pool_mode_ == THREAD_POOL_MODE::MODE_STEALING) {
+			if (task_size_ >= task_threshhold_) {
+				std::unique_lock<std::mutex> lock(task_queue_mtx_);
+				if (!wait_room(lock)) {
+					lock.unlock();
+					return run_in_caller(task);
+				}
+			}
+			submit_stealing(_MSTL move(task), priority);
+			return true;
+		}
 
 		std::unique_lock<std::mutex> lock(task_queue_mtx_);
-		if (!not_full_.wait_for(lock, std::chrono::seconds(1),
-			[&]()->bool { return task_queue_.size() < task_threshhold_; })) {
-			auto task_ = _MSTL make_shared<std::packaged_task<Result()>>([]() -> Result { return Result(); });
-			(*task_)();
-			return task_->get_future();
+		if (!wait_room(lock)) {
+			lock.unlock();
+			return run_in_caller(task);
 		}
-		task_queue_.emplace([task] { (*task)(); });
+		push_queued(box(_MSTL move(task)), priority);
 		++task_size_;
 		not_empty_.notify_all();
 		if (pool_mode_ == THREAD_POOL_MODE::MODE_CACHED
@@ -322,7 +981,13 @@ public:
 			threads_map_[thread_id]->start();
 			++idle_thread_size_;
 		}
-		return res;
+		return true;
+	}
+
+	bool run_in_caller(Task& task) {
+		if (full_policy_ != FULL_POLICY::CALLER_RUNS) return false;
+		task();
+		return true;
 	}
 };
 
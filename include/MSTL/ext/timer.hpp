@@ -1,8 +1,11 @@
 #ifndef MSTL_TIMER_HPP__
 #define MSTL_TIMER_HPP__
-#include "MSTL/core/set.hpp"
 #include "MSTL/core/functional.hpp"
+#include "MSTL/core/vector.hpp"
 #include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
 MSTL_BEGIN_NAMESPACE__
 
 struct __timer_node_base {
@@ -25,25 +28,14 @@ public:
     MSTL_NODISCARD size_t id() const { return id_; }
 };
 
+// what a callback sees of its own timer.
 struct timer_node : __timer_node_base {
 public:
     using call_back = _MSTL function<void(const timer_node& node)>;
 
-private:
-	call_back func_;
-
-public:
     timer_node() = default;
-    timer_node(const int64_t expire, const size_t id, call_back func)
-        : __timer_node_base(expire, id), func_(_MSTL move(func)) {}
-
-    timer_node(const timer_node& node) = default;
-    timer_node& operator=(const timer_node& node) = default;
-    timer_node(timer_node&& node) = default;
-    timer_node& operator=(timer_node&& node) = default;
-    ~timer_node() = default;
-
-    MSTL_NODISCARD const call_back& hold() const { return func_; }
+    timer_node(const int64_t expire, const size_t id)
+        : __timer_node_base(expire, id) {}
 };
 
 inline bool operator <(const __timer_node_base& lh, const __timer_node_base& rh) {
@@ -53,23 +45,256 @@ inline bool operator <(const __timer_node_base& lh, const __timer_node_base& rh)
 }
 
 
+struct __timer_link {
+    __timer_link* prev;
+    __timer_link* next;
+
+    __timer_link() noexcept : prev(this), next(this) {}
+    __timer_link(const __timer_link&) = delete;
+    __timer_link& operator =(const __timer_link&) = delete;
+
+    MSTL_NODISCARD bool empty() const noexcept { return next == this; }
+};
+
+struct __timer_entry : __timer_link {
+    uint64_t tick = 0;
+    int64_t expire = 0;
+    size_t id = 0;  // 0 while the entry sits in the free list
+    timer_node::call_back func{};
+};
+
+class timer;
+
+// refers to a scheduled timer, stays valid to compare against after it fired or was erased.
+struct timer_handle : __timer_node_base {
+private:
+    __timer_entry* entry_ = nullptr;
+
+    friend class timer;
+
+    timer_handle(const int64_t expire, const size_t id, __timer_entry* entry)
+        : __timer_node_base(expire, id), entry_(entry) {}
+
+public:
+    timer_handle() = default;
+};
+
+
+// hierarchical hashed timing wheel (Varghese & Lauck). a 256 slot root wheel
+// holds what is due within 256 ticks, three 64 slot wheels above it hold
+// coarser spans and are cascaded down as the root wraps around. add and erase
+// are O(1), entries come from a free list and every timer of a tick fires in
+// one check. timers further than 2^26 ticks away park in the last wheel and
+// are placed again whenever they cascade.
 class timer {
 public:
     using node_type = timer_node;
+    using handle_type = timer_handle;
     using func_type = timer_node::call_back;
 
 private:
-    _MSTL set<node_type> timer_set_;
+    static constexpr size_t ROOT_BITS = 8;
+    static constexpr size_t ROOT_SIZE = size_t(1) << ROOT_BITS;
+    static constexpr size_t LEVEL_BITS = 6;
+    static constexpr size_t LEVEL_SIZE = size_t(1) << LEVEL_BITS;
+    static constexpr size_t LEVELS = 3;
+    static constexpr uint64_t MAX_SPAN = uint64_t(1) << (ROOT_BITS + LEVEL_BITS * LEVELS);
+    static constexpr size_t CHUNK_SIZE = 1024;
+
+    __timer_link root_[ROOT_SIZE];
+    __timer_link levels_[LEVELS][LEVEL_SIZE];
+    uint64_t current_ = 0;  // next tick to run
+    int64_t base_;
+    int64_t resolution_;
+    size_t last_id_ = 0;
+    size_t size_ = 0;
+
+    vector<__timer_entry*> chunks_{};
+    __timer_entry* free_ = nullptr;
+
+    mutable std::mutex mtx_;
+    std::condition_variable driver_cond_;
+    std::thread driver_;
+    bool driving_ = false;
+    uint64_t wake_tick_ = 0;
+
+    static void link_back(__timer_link& list, __timer_link* node) noexcept {
+        node->prev = list.prev;
+        node->next = &list;
+        list.prev->next = node;
+        list.prev = node;
+    }
+
+    static void unlink(__timer_link* node) noexcept {
+        node->prev->next = node->next;
+        node->next->prev = node->prev;
+        node->prev = node->next = node;
+    }
+
+    // appends every node of from to to and leaves from empty.
+    static void splice(__timer_link& from, __timer_link& to) noexcept {
+        if (from.empty()) return;
+        from.next->prev = to.prev;
+        to.prev->next = from.next;
+        from.prev->next = &to;
+        to.prev = from.prev;
+        from.prev = from.next = &from;
+    }
 
-    static size_t generate_id() {
-        static size_t timer_id_ = 0;
-        return ++timer_id_;
+    __timer_entry* acquire_entry() {
+        if (free_ == nullptr) {
+            auto* chunk = new __timer_entry[CHUNK_SIZE];
+            chunks_.push_back(chunk);
+            for (size_t i = 0; i < CHUNK_SIZE; ++i) {
+                chunk[i].next = free_;
+                free_ = &chunk[i];
+            }
+        }
+        __timer_entry* entry = free_;
+        free_ = static_cast<__timer_entry*>(entry->next);
+        entry->prev = entry->next = entry;
+        return entry;
+    }
+
+    void release_entry(__timer_entry* entry) noexcept {
+        entry->func = func_type();
+        entry->id = 0;
+        entry->next = free_;
+        free_ = entry;
+        --size_;
+    }
+
+    // rounded up, a timer never fires before its expire time.
+    uint64_t tick_of(const int64_t expire) const noexcept {
+        return expire <= base_ ? 0 : static_cast<uint64_t>((expire - base_ + resolution_ - 1) / resolution_);
+    }
+
+    uint64_t elapsed_ticks(const int64_t now) const noexcept {
+        return now <= base_ ? 0 : static_cast<uint64_t>((now - base_) / resolution_);
+    }
+
+    void place(__timer_entry* entry) noexcept {
+        uint64_t tick = entry->tick < current_ ? current_ : entry->tick;
+        uint64_t delta = tick - current_;
+        if (delta >= MAX_SPAN) {
+            delta = MAX_SPAN - 1;
+            tick = current_ + delta;
+        }
+        if (delta < ROOT_SIZE) {
+            link_back(root_[tick & (ROOT_SIZE - 1)], entry);
+            return;
+        }
+        for (size_t level = 0; level < LEVELS; ++level) {
+            const size_t shift = ROOT_BITS + level * LEVEL_BITS;
+            if (delta < uint64_t(1) << (shift + LEVEL_BITS)) {
+                link_back(levels_[level][(tick >> shift) & (LEVEL_SIZE - 1)], entry);
+                return;
+            }
+        }
+    }
+
+    void cascade(const size_t level, const size_t index) noexcept {
+        __timer_link pending;
+        splice(levels_[level][index], pending);
+        while (!pending.empty()) {
+            auto* entry = static_cast<__timer_entry*>(pending.next);
+            unlink(entry);
+            place(entry);
+        }
+    }
+
+    // runs the wheel up to target and moves every due entry to due.
+    void collect(const uint64_t target, __timer_link& due) noexcept {
+        if (size_ == 0) {
+            if (current_ <= target) current_ = target + 1;
+            return;
+        }
+        for (; current_ <= target; ++current_) {
+            const size_t index = current_ & (ROOT_SIZE - 1);
+            if (index == 0) {
+                for (size_t level = 0; level < LEVELS; ++level) {
+                    const size_t slot = (current_ >> (ROOT_BITS + level * LEVEL_BITS)) & (LEVEL_SIZE - 1);
+                    cascade(level, slot);
+                    if (slot != 0) break;
+                }
+            }
+            splice(root_[index], due);
+        }
+    }
+
+    // the next tick worth waking up for, the root wrap when nothing is due before it.
+    uint64_t next_tick() const noexcept {
+        uint64_t tick = current_;
+        while (root_[tick & (ROOT_SIZE - 1)].empty() && ((tick + 1) & (ROOT_SIZE - 1)) != 0) ++tick;
+        return root_[tick & (ROOT_SIZE - 1)].empty() ? tick + 1 : tick;
+    }
+
+    // the tick of the earliest timer. the first used slot of each wheel holds
+    // the earliest timers of that wheel, but any wheel may hold the overall one.
+    uint64_t earliest_tick() const noexcept {
+        uint64_t earliest = ~uint64_t(0);
+        for (uint64_t tick = current_; tick < current_ + ROOT_SIZE; ++tick) {
+            if (!root_[tick & (ROOT_SIZE - 1)].empty()) {
+                earliest = tick;
+                break;
+            }
+        }
+        for (size_t level = 0; level < LEVELS; ++level) {
+            const uint64_t position = current_ >> (ROOT_BITS + level * LEVEL_BITS);
+            for (size_t step = 1; step <= LEVEL_SIZE; ++step) {
+                const __timer_link& slot = levels_[level][(position + step) & (LEVEL_SIZE - 1)];
+                if (slot.empty()) continue;
+                for (const __timer_link* node = slot.next; node != &slot; node = node->next) {
+                    const uint64_t tick = static_cast<const __timer_entry*>(node)->tick;
+                    earliest = _MSTL min(earliest, tick < current_ ? current_ : tick);
+                }
+                break;
+            }
+        }
+        return earliest;
+    }
+
+    int64_t wait_time(const uint64_t tick) const noexcept {
+        const int64_t dis = base_ + static_cast<int64_t>(tick) * resolution_ - get_tick();
+        return dis > 0 ? dis : 0;
+    }
+
+    void drive() {
+        std::unique_lock<std::mutex> lock(mtx_);
+        while (driving_) {
+            if (size_ == 0) {
+                wake_tick_ = ~uint64_t(0);
+                driver_cond_.wait(lock);
+            } else {
+                wake_tick_ = next_tick();
+                driver_cond_.wait_for(lock, std::chrono::microseconds(wait_time(wake_tick_)));
+            }
+            if (!driving_) break;
+            lock.unlock();
+            try {
+                check();
+            } catch (...) {
+                // a throwing callback must not end the thread, its remaining timers stay due
+            }
+            lock.lock();
+        }
     }
 
 public:
-    timer() = default;
-    ~timer() = default;
+    explicit timer(const int64_t resolution_us = 1000)
+        : base_(get_tick()), resolution_(resolution_us) {
+        Exception(resolution_us > 0, ValueError("timer resolution must be positive"));
+    }
+
+    timer(const timer&) = delete;
+    timer& operator =(const timer&) = delete;
+
+    ~timer() {
+        stop();
+        for (__timer_entry* chunk : chunks_) delete[] chunk;
+    }
 
+    // microseconds of the steady clock.
     static int64_t get_tick() {
         const auto sc
             = std::chrono::time_point_cast<std::chrono::microseconds>(std::chrono::steady_clock::now());
@@ -78,36 +303,87 @@ public:
         return sub.count();
     }
 
-    node_type add(const int64_t ms, const func_type &func) {
-        node_type tnode(get_tick() + ms, generate_id(), func);
-        timer_set_.insert(tnode);
-        return tnode;
+    handle_type add(const int64_t ms, func_type func) {
+        const int64_t expire = get_tick() + ms * 1000;
+        std::lock_guard<std::mutex> lock(mtx_);
+        __timer_entry* entry = acquire_entry();
+        entry->tick = tick_of(expire);
+        entry->expire = expire;
+        entry->id = ++last_id_;
+        entry->func = _MSTL move(func);
+        place(entry);
+        ++size_;
+        if (driving_ && entry->tick < wake_tick_) driver_cond_.notify_one();
+        return handle_type(expire, entry->id, entry);
     }
 
-    bool erase(const node_type& node)  {
-        const auto iter = timer_set_.find(node);
-        if (iter != timer_set_.end()) {
-            timer_set_.erase(iter);
-            return true;
-        }
-        return false;
+    // false when the timer already fired, is firing or was erased.
+    bool erase(const handle_type& handle) {
+        std::lock_guard<std::mutex> lock(mtx_);
+        __timer_entry* entry = handle.entry_;
+        if (entry == nullptr || entry->id != handle.id() || entry->next == entry) return false;
+        unlink(entry);
+        release_entry(entry);
+        return true;
     }
 
+    // fires every timer that is due, callbacks run without the lock held
+    // and may add or erase timers.
     bool check() {
-        const auto iter = timer_set_.begin();
-        if (iter != timer_set_.end() && iter->expire() <= get_tick()) {
-            iter->hold()(*iter);
-            timer_set_.erase(iter);
-            return true;
+        __timer_link due;
+        std::unique_lock<std::mutex> lock(mtx_);
+        collect(elapsed_ticks(get_tick()), due);
+        bool fired = false;
+        while (!due.empty()) {
+            auto* entry = static_cast<__timer_entry*>(due.next);
+            unlink(entry);
+            const node_type node(entry->expire, entry->id);
+            func_type func = _MSTL move(entry->func);
+            release_entry(entry);
+            lock.unlock();
+            try {
+                func(node);
+            } catch (...) {
+                // the rest fires on the next check
+                lock.lock();
+                splice(due, root_[current_ & (ROOT_SIZE - 1)]);
+                throw;
+            }
+            fired = true;
+            lock.lock();
         }
-        return false;
+        return fired;
     }
 
-    int64_t sleep() {
-        const auto iter = timer_set_.begin();
-        if (iter == timer_set_.end()) return -1;
-        const int64_t dis = iter->expire() - get_tick();
-        return dis > 0 ? dis : 0;
+    // microseconds until the earliest timer is due, -1 without timers.
+    int64_t sleep() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (size_ == 0) return -1;
+        return wait_time(earliest_tick());
+    }
+
+    // fires the timers from a dedicated thread until stop.
+    bool start() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (driving_) return false;
+        driving_ = true;
+        driver_ = std::thread(&timer::drive, this);
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            if (!driving_) return;
+            driving_ = false;
+        }
+        driver_cond_.notify_all();
+        driver_.join();
+    }
+
+    MSTL_NODISCARD size_t size() const {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return size_;
     }
 };
 
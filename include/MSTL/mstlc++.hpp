@@ -3,6 +3,8 @@
 
 #include <MSTL/core/print.hpp>
 #include <MSTL/ext/lock_free_queue.hpp>
+#include <MSTL/ext/ring_buffer.hpp>
+#include <MSTL/ext/reclamation.hpp>
 #include <MSTL/ext/trace_memory.hpp>
 #include <MSTL/ext/database_pool.hpp>
 #include <MSTL/ext/thread_pool.hpp>
@@ -0,0 +1,190 @@
+#ifndef MSTL_HTTP_PARSER_HPP__
+#define MSTL_HTTP_PARSER_HPP__
+#include "MSTL/core/string_view.hpp"
+#include "MSTL/core/vector.hpp"
+#include <cstring>
+MSTL_BEGIN_NAMESPACE__
+
+enum class HTTP_PARSE_STATUS {
+    INCOMPLETE,  // wait for more bytes
+    COMPLETE,
+    MALFORMED,
+    TOO_LARGE,      // header section over the limit
+    BODY_TOO_LARGE  // declared body over the limit, detected before it is read
+};
+
+// resumable request parser working in place on a connection buffer.
+// parts of the request are kept as offsets from the request start, so the
+// buffer may grow or move between calls as long as the request start stays
+// at the same offset. nothing is copied, views are produced on demand.
+class http_parser {
+public:
+    struct slice {
+        size_t offset = 0;
+        size_t length = 0;
+
+        MSTL_NODISCARD string_view view(const char* data) const noexcept {
+            return {data + offset, length};
+        }
+    };
+
+    struct header {
+        slice name;
+        slice value;
+    };
+
+private:
+    enum class STATE { REQUEST_LINE, HEADER_LINE, BODY, DONE };
+
+    STATE state_ = STATE::REQUEST_LINE;
+    size_t line_start_ = 0;
+    size_t max_header_size_;
+    size_t max_body_size_;
+    size_t content_length_ = 0;
+    bool has_length_ = false;
+    bool body_too_large_ = false;
+    slice method_{};
+    slice path_{};
+    slice query_{};
+    slice version_{};
+    slice body_{};
+    vector<header> headers_{};
+
+    static bool is_blank(const char c) noexcept {
+        return c == ' ' || c == '\t';
+    }
+
+    static slice trim(const char* data, size_t begin, size_t end) noexcept {
+        while (begin < end && is_blank(data[begin])) ++begin;
+        while (end > begin && is_blank(data[end - 1])) --end;
+        return {begin, end - begin};
+    }
+
+    static bool equal_ignore_case(const char* data, const slice& s, const char* name, const size_t length) noexcept {
+        return s.length == length && _MSTL memory_compare_ignore_case(data + s.offset, name, length) == 0;
+    }
+
+    bool parse_request_line(const char* data, const size_t begin, const size_t end) {
+        const char* first = data + begin;
+        const char* last = data + end;
+        const auto* sp1 = static_cast<const char*>(std::memchr(first, ' ', end - begin));
+        if (sp1 == nullptr || sp1 == first) return false;
+        const auto* sp2 = static_cast<const char*>(std::memchr(sp1 + 1, ' ', last - sp1 - 1));
+        if (sp2 == nullptr || sp2 == sp1 + 1) return false;
+
+        method_ = {begin, static_cast<size_t>(sp1 - first)};
+        const size_t target = sp1 + 1 - data;
+        const size_t target_end = sp2 - data;
+        const auto* mark = static_cast<const char*>(std::memchr(data + target, '?', target_end - target));
+        if (mark != nullptr) {
+            path_ = {target, static_cast<size_t>(mark - data) - target};
+            query_ = {static_cast<size_t>(mark - data) + 1, target_end - static_cast<size_t>(mark - data) - 1};
+        } else {
+            path_ = {target, target_end - target};
+            query_ = {target_end, 0};
+        }
+        version_ = trim(data, target_end + 1, end);
+        return version_.length != 0;
+    }
+
+    bool parse_header_line(const char* data, const size_t begin, const size_t end) {
+        const auto* colon = static_cast<const char*>(std::memchr(data + begin, ':', end - begin));
+        if (colon == nullptr || colon == data + begin) return false;
+
+        const size_t colon_pos = colon - data;
+        header h;
+        h.name = trim(data, begin, colon_pos);
+        h.value = trim(data, colon_pos + 1, end);
+
+        if (equal_ignore_case(data, h.name, "Content-Length", 14)) {
+            if (h.value.length == 0) return false;
+            size_t length = 0;
+            bool too_large = false;
+            for (size_t i = 0; i < h.value.length; ++i) {
+                const char c = data[h.value.offset + i];
+                if (!_MSTL is_digit(c)) return false;
+                const size_t digit = c - '0';
+                if (too_large || digit > max_body_size_ || length > (max_body_size_ - digit) / 10) too_large = true;
+                else length = length * 10 + digit;
+            }
+            // repeated lengths must agree, otherwise the framing is ambiguous
+            if (has_length_ && (too_large != body_too_large_ || (!too_large && length != content_length_))) {
+                return false;
+            }
+            has_length_ = true;
+            body_too_large_ = too_large;
+            content_length_ = length;
+        } else if (equal_ignore_case(data, h.name, "Transfer-Encoding", 17)) {
+            // chunked bodies are not supported
+            return false;
+        }
+        headers_.push_back(h);
+        return true;
+    }
+
+public:
+    explicit http_parser(const size_t max_header_size = 1024 * 16, const size_t max_body_size = 1024 * 1024 * 8)
+        : max_header_size_(max_header_size), max_body_size_(max_body_size) {}
+
+    // parse the request starting at data, size is every byte received so far.
+    // scanning continues where the last call stopped.
+    HTTP_PARSE_STATUS parse(const char* data, const size_t size) {
+        while (state_ == STATE::REQUEST_LINE || state_ == STATE::HEADER_LINE) {
+            const auto* lf = line_start_ < size ? static_cast<const char*>(
+                std::memchr(data + line_start_, '\n', size - line_start_)) : nullptr;
+            if (lf == nullptr) {
+                return size > max_header_size_ ? HTTP_PARSE_STATUS::TOO_LARGE : HTTP_PARSE_STATUS::INCOMPLETE;
+            }
+
+            const size_t begin = line_start_;
+            size_t end = lf - data;
+            line_start_ = end + 1;
+            if (line_start_ > max_header_size_) return HTTP_PARSE_STATUS::TOO_LARGE;
+            if (end > begin && data[end - 1] == '\r') --end;
+
+            if (state_ == STATE::REQUEST_LINE) {
+                if (end == begin) continue;  // tolerate empty lines before the request
+                if (!parse_request_line(data, begin, end)) return HTTP_PARSE_STATUS::MALFORMED;
+                state_ = STATE::HEADER_LINE;
+            } else if (end == begin) {
+                if (body_too_large_) return HTTP_PARSE_STATUS::BODY_TOO_LARGE;
+                body_ = {line_start_, content_length_};
+                state_ = STATE::BODY;
+            } else if (!parse_header_line(data, begin, end)) {
+                return HTTP_PARSE_STATUS::MALFORMED;
+            }
+        }
+
+        if (state_ == STATE::BODY) {
+            if (size - body_.offset < body_.length) return HTTP_PARSE_STATUS::INCOMPLETE;
+            state_ = STATE::DONE;
+        }
+        return HTTP_PARSE_STATUS::COMPLETE;
+    }
+
+    // forget the finished request, the next one starts at a new offset.
+    void reset() noexcept {
+        state_ = STATE::REQUEST_LINE;
+        line_start_ = 0;
+        content_length_ = 0;
+        has_length_ = body_too_large_ = false;
+        method_ = path_ = query_ = version_ = body_ = slice{};
+        headers_.clear();
+    }
+
+    MSTL_NODISCARD bool is_complete() const noexcept { return state_ == STATE::DONE; }
+
+    // bytes taken by the complete request, the next pipelined one starts right after.
+    MSTL_NODISCARD size_t request_size() const noexcept { return body_.offset + body_.length; }
+
+    MSTL_NODISCARD const slice& method() const noexcept { return method_; }
+    MSTL_NODISCARD const slice& path() const noexcept { return path_; }
+    MSTL_NODISCARD const slice& query() const noexcept { return query_; }
+    MSTL_NODISCARD const slice& version() const noexcept { return version_; }
+    MSTL_NODISCARD const slice& body() const noexcept { return body_; }
+    MSTL_NODISCARD const vector<header>& headers() const noexcept { return headers_; }
+    MSTL_NODISCARD size_t content_length() const noexcept { return content_length_; }
+};
+
+MSTL_END_NAMESPACE__
+#endif // MSTL_HTTP_PARSER_HPP__
@@ -0,0 +1,275 @@
+#ifndef MSTL_HTTP_WRITER_HPP__
+#define MSTL_HTTP_WRITER_HPP__
+#include "socket.hpp"
+#include "MSTL/core/file.hpp"
+#include "MSTL/core/memory.hpp"
+#ifdef MSTL_PLATFORM_LINUX__
+#include <sys/uio.h>
+#include <sys/mman.h>
+#include <sys/sendfile.h>
+#include <cerrno>
+#endif
+MSTL_BEGIN_NAMESPACE__
+
+// read only view of a whole file mapped into memory, unmapped with the last owner.
+class mapped_file {
+private:
+    const char* data_ = nullptr;
+    size_t size_ = 0;
+#ifdef MSTL_PLATFORM_WINDOWS__
+    HANDLE mapping_ = nullptr;
+#endif
+
+public:
+    mapped_file() = default;
+    mapped_file(const mapped_file&) = delete;
+    mapped_file& operator =(const mapped_file&) = delete;
+
+    ~mapped_file() {
+        unmap();
+    }
+
+    bool map(const file& source) {
+        unmap();
+        if (!source.opened()) return false;
+        const size_t size = source.size();
+        if (size == 0) return true;
+#ifdef MSTL_PLATFORM_LINUX__
+        void* data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, source.native_handle(), 0);
+        if (data == MAP_FAILED) return false;
+#elif defined(MSTL_PLATFORM_WINDOWS__)
+        mapping_ = ::CreateFileMappingA(source.native_handle(), nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (mapping_ == nullptr) return false;
+        void* data = ::MapViewOfFile(mapping_, FILE_MAP_READ, 0, 0, size);
+        if (data == nullptr) {
+            ::CloseHandle(mapping_);
+            mapping_ = nullptr;
+            return false;
+        }
+#endif
+        data_ = static_cast<const char*>(data);
+        size_ = size;
+        return true;
+    }
+
+    void unmap() {
+        if (data_ == nullptr) return;
+#ifdef MSTL_PLATFORM_LINUX__
+        ::munmap(const_cast<char*>(data_), size_);
+#elif defined(MSTL_PLATFORM_WINDOWS__)
+        ::UnmapViewOfFile(data_);
+        ::CloseHandle(mapping_);
+        mapping_ = nullptr;
+#endif
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    MSTL_NODISCARD const char* data() const noexcept { return data_; }
+    MSTL_NODISCARD size_t size() const noexcept { return size_; }
+};
+
+enum class HTTP_WRITE_STATUS {
+    DONE,   // everything queued has been sent
+    AGAIN,  // socket buffer full, retry when writable
+    FAILED
+};
+
+// queue of outgoing response pieces for one connection.
+// status lines and headers go into a single reusable buffer, bodies are
+// referenced where they live, and the whole queue leaves with one sendmsg
+// per gather or one sendfile per file range.
+class http_writer {
+private:
+    enum class SEGMENT { HEAD, BODY, MAPPED, FILE };
+
+    struct segment {
+        SEGMENT type = SEGMENT::HEAD;
+        size_t offset = 0;
+        size_t length = 0;
+        string body{};
+        shared_ptr<file> source{};
+        shared_ptr<mapped_file> mapping{};
+
+        segment() = default;
+        segment(const SEGMENT type, const size_t offset, const size_t length)
+            : type(type), offset(offset), length(length) {}
+    };
+
+    string head_{};
+    vector<segment> segments_{};
+    size_t first_ = 0;
+    size_t head_mark_ = 0;
+    size_t queued_ = 0;  // bytes committed and not yet sent
+
+    // bodies up to this size are copied behind their head, saving an iovec
+    static constexpr size_t INLINE_BODY_SIZE = 1024;
+
+    const char* segment_data(const segment& seg) const noexcept {
+        switch (seg.type) {
+            case SEGMENT::HEAD:
+                return head_.data() + seg.offset;
+            case SEGMENT::MAPPED:
+                return seg.mapping->data() + seg.offset;
+            default:
+                return seg.body.data() + seg.offset;
+        }
+    }
+
+    void reset() {
+        segments_.clear();
+        head_.clear();
+        first_ = 0;
+        head_mark_ = 0;
+        queued_ = 0;
+    }
+
+    void consume(size_t bytes) noexcept {
+        queued_ -= bytes;
+        while (bytes > 0) {
+            segment& seg = segments_[first_];
+            const size_t step = _MSTL min(bytes, seg.length);
+            seg.offset += step;
+            seg.length -= step;
+            bytes -= step;
+            if (seg.length == 0) ++first_;
+        }
+        while (first_ < segments_.size() && segments_[first_].length == 0) ++first_;
+    }
+
+public:
+    http_writer() = default;
+    http_writer(const http_writer&) = delete;
+    http_writer& operator =(const http_writer&) = delete;
+    http_writer(http_writer&&) noexcept = default;
+    http_writer& operator =(http_writer&&) noexcept = default;
+
+    // append head bytes here, then call commit_head.
+    string& head() noexcept {
+        return head_;
+    }
+
+    void commit_head() {
+        if (head_.size() == head_mark_) return;
+        queued_ += head_.size() - head_mark_;
+        if (!segments_.empty() && segments_.back().type == SEGMENT::HEAD) {
+            segments_.back().length += head_.size() - head_mark_;
+        } else {
+            segments_.emplace_back(SEGMENT::HEAD, head_mark_, head_.size() - head_mark_);
+        }
+        head_mark_ = head_.size();
+    }
+
+    void append_head(const char* data, const size_t length) {
+        head_.append(data, length);
+        commit_head();
+    }
+
+    void append_body(string body) {
+        if (body.empty()) return;
+        if (body.size() <= INLINE_BODY_SIZE) {
+            append_head(body.data(), body.size());
+            return;
+        }
+        commit_head();
+        const size_t length = body.size();
+        queued_ += length;
+        segments_.emplace_back(SEGMENT::BODY, 0, length);
+        segments_.back().body = _MSTL move(body);
+    }
+
+    void append_mapping(shared_ptr<mapped_file> mapping, const size_t offset, const size_t length) {
+        if (length == 0) return;
+        commit_head();
+        queued_ += length;
+        segments_.emplace_back(SEGMENT::MAPPED, offset, length);
+        segments_.back().mapping = _MSTL move(mapping);
+    }
+
+    void append_file(shared_ptr<file> source, const size_t offset, const size_t length) {
+        if (length == 0) return;
+        commit_head();
+        queued_ += length;
+        segments_.emplace_back(SEGMENT::FILE, offset, length);
+        segments_.back().source = _MSTL move(source);
+    }
+
+    MSTL_NODISCARD bool empty() const noexcept {
+        return first_ == segments_.size();
+    }
+
+    // bytes of committed responses still waiting to be sent, mapped and file ranges included.
+    MSTL_NODISCARD size_t queued() const noexcept {
+        return queued_;
+    }
+
+    HTTP_WRITE_STATUS flush(const socket::socket_t client_socket) {
+#ifdef MSTL_PLATFORM_LINUX__
+        constexpr int MAX_IOV = 64;
+        while (first_ < segments_.size()) {
+            segment& seg = segments_[first_];
+            if (seg.type == SEGMENT::FILE) {
+                auto offset = static_cast<::off_t>(seg.offset);
+                const ssize_t bytes_sent = ::sendfile(client_socket,
+                    seg.source->native_handle(), &offset, seg.length);
+                if (bytes_sent < 0) {
+                    if (errno == EINTR) continue;
+                    if (errno == EAGAIN || errno == EWOULDBLOCK) return HTTP_WRITE_STATUS::AGAIN;
+                    return HTTP_WRITE_STATUS::FAILED;
+                }
+                if (bytes_sent == 0) return HTTP_WRITE_STATUS::FAILED;  // file shrank
+                consume(static_cast<size_t>(bytes_sent));
+                continue;
+            }
+
+            ::iovec iov[MAX_IOV];
+            int count = 0;
+            for (size_t i = first_; i < segments_.size() && count < MAX_IOV; ++i) {
+                const segment& part = segments_[i];
+                if (part.type == SEGMENT::FILE) break;
+                iov[count].iov_base = const_cast<char*>(segment_data(part));
+                iov[count].iov_len = part.length;
+                ++count;
+            }
+            ::msghdr message{};
+            message.msg_iov = iov;
+            message.msg_iovlen = count;
+            const ssize_t bytes_sent = ::sendmsg(client_socket, &message, MSG_NOSIGNAL);
+            if (bytes_sent < 0) {
+                if (errno == EINTR) continue;
+                if (errno == EAGAIN || errno == EWOULDBLOCK) return HTTP_WRITE_STATUS::AGAIN;
+                return HTTP_WRITE_STATUS::FAILED;
+            }
+            consume(static_cast<size_t>(bytes_sent));
+        }
+#elif defined(MSTL_PLATFORM_WINDOWS__)
+        while (first_ < segments_.size()) {
+            segment& seg = segments_[first_];
+            if (seg.type == SEGMENT::FILE) {
+                string chunk;
+                if (!seg.source->seek(static_cast<file::difference_type>(seg.offset), FILE_POINTER::BEGIN) ||
+                    seg.source->read_binary(chunk, _MSTL min(seg.length, static_cast<size_t>(1 << 16))) == 0) {
+                    return HTTP_WRITE_STATUS::FAILED;
+                }
+                size_t sent = 0;
+                while (sent < chunk.size()) {
+                    const int bytes_sent = ::send(client_socket, chunk.data() + sent,
+                        static_cast<int>(chunk.size() - sent), 0);
+                    if (bytes_sent <= 0) return HTTP_WRITE_STATUS::FAILED;
+                    sent += bytes_sent;
+                }
+                consume(sent);
+                continue;
+            }
+            const int bytes_sent = ::send(client_socket, segment_data(seg), static_cast<int>(seg.length), 0);
+            if (bytes_sent <= 0) return HTTP_WRITE_STATUS::FAILED;
+            consume(static_cast<size_t>(bytes_sent));
+        }
+#endif
+        reset();
+        return HTTP_WRITE_STATUS::DONE;
+    }
+};
+
+MSTL_END_NAMESPACE__
+#endif // MSTL_HTTP_WRITER_HPP__
@@ -0,0 +1,190 @@
+#ifndef MSTL_ROUTER_HPP__
+#define MSTL_ROUTER_HPP__
+#include "MSTL/core/functional.hpp"
+#include "MSTL/core/memory.hpp"
+#include "MSTL/core/string.hpp"
+#include "MSTL/core/vector.hpp"
+MSTL_BEGIN_NAMESPACE__
+
+MSTL_ERROR_BUILD_FINAL_CLASS(RouteError, ValueError, "Route Registration Failed");
+
+struct http_request;
+struct http_response;
+
+using route_handler = _MSTL function<void(http_request&, http_response&)>;
+using route_captures = vector<pair<string, string>>;
+
+// compressed radix tree over the static bytes of the registered patterns.
+// ":name" captures one non-empty segment, "*name" captures the rest of the path
+// and has to come last. static edges are tried before captures, so matching
+// costs O(path length) whatever the number of routes.
+class http_router {
+private:
+    struct __route_node {
+        string prefix{};
+        vector<unique_ptr<__route_node>> children{};  // static, distinct first bytes
+        unique_ptr<__route_node> param{};
+        unique_ptr<__route_node> wildcard{};
+        string name{};  // capture name of param and wildcard nodes
+        route_handler handler{};
+        bool routable = false;
+    };
+
+    struct __route_tree {
+        string method{};
+        unique_ptr<__route_node> root{};
+    };
+
+    vector<__route_tree> trees_{};
+
+    static size_t common_prefix(const string& lh, const string_view rh) noexcept {
+        const size_t limit = _MSTL min(lh.size(), rh.size());
+        size_t i = 0;
+        while (i < limit && lh.data()[i] == rh.data()[i]) ++i;
+        return i;
+    }
+
+    static __route_node* static_child(__route_node* node, string_view literal) {
+        for (auto& child : node->children) {
+            if (child->prefix.data()[0] != literal.data()[0]) continue;
+
+            const size_t common = common_prefix(child->prefix, literal);
+            if (common < child->prefix.size()) {
+                // split the edge at the first differing byte
+                auto middle = _MSTL make_unique<__route_node>();
+                middle->prefix = child->prefix.substr(0, common);
+                child->prefix.erase(0, common);
+                middle->children.push_back(_MSTL move(child));
+                child = _MSTL move(middle);
+            }
+            literal.remove_prefix(common);
+            return literal.empty() ? child.get() : static_child(child.get(), literal);
+        }
+
+        auto created = _MSTL make_unique<__route_node>();
+        created->prefix = string(literal);
+        node->children.push_back(_MSTL move(created));
+        return node->children.back().get();
+    }
+
+    static __route_node* capture_child(unique_ptr<__route_node>& slot, const string_view name) {
+        if (name.empty()) {
+            Exception(RouteError("route capture without a name"));
+        }
+        if (!slot) {
+            slot = _MSTL make_unique<__route_node>();
+            slot->name = string(name);
+        } else if (string_view(slot->name.data(), slot->name.size()) != name) {
+            Exception(RouteError("conflicting capture names at the same route position"));
+        }
+        return slot.get();
+    }
+
+    static __route_node* insert(__route_node* node, string_view pattern) {
+        while (!pattern.empty()) {
+            const char lead = pattern.data()[0];
+            if (lead == ':') {
+                size_t end = pattern.find('/');
+                if (end == string_view::npos) end = pattern.size();
+                node = capture_child(node->param, pattern.substr(1, end - 1));
+                pattern.remove_prefix(end);
+            } else if (lead == '*') {
+                if (pattern.find('/') != string_view::npos) {
+                    Exception(RouteError("wildcard must be the last part of a route"));
+                }
+                node = capture_child(node->wildcard, pattern.substr(1));
+                pattern = string_view();
+            } else {
+                size_t end = pattern.find_first_of(":*");
+                if (end == string_view::npos) end = pattern.size();
+                node = static_child(node, pattern.substr(0, end));
+                pattern.remove_prefix(end);
+            }
+        }
+        return node;
+    }
+
+    static const __route_node* match(const __route_node* node, const string_view path, route_captures& captures) {
+        if (path.empty()) {
+            if (node->routable) return node;
+        } else {
+            for (const auto& child : node->children) {
+                const string& prefix = child->prefix;
+                if (prefix.data()[0] != path.data()[0]) continue;
+                if (path.size() >= prefix.size() &&
+                    _MSTL memory_compare(path.data(), prefix.data(), prefix.size()) == 0) {
+                    if (const auto* found = match(child.get(), path.substr(prefix.size()), captures))
+                        return found;
+                }
+                break;
+            }
+
+            if (node->param) {
+                size_t end = path.find('/');
+                if (end == string_view::npos) end = path.size();
+                if (end != 0) {
+                    captures.emplace_back(node->param->name, string(path.substr(0, end)));
+                    if (const auto* found = match(node->param.get(), path.substr(end), captures))
+                        return found;
+                    captures.pop_back();
+                }
+            }
+        }
+
+        if (node->wildcard && node->wildcard->routable) {
+            captures.emplace_back(node->wildcard->name, string(path));
+            return node->wildcard.get();
+        }
+        return nullptr;
+    }
+
+    const __route_tree* find_tree(const string_view method) const {
+        for (const auto& tree : trees_) {
+            if (string_view(tree.method.data(), tree.method.size()) == method) return &tree;
+        }
+        return nullptr;
+    }
+
+public:
+    http_router() = default;
+    http_router(const http_router&) = delete;
+    http_router& operator =(const http_router&) = delete;
+
+    void add(const string& method, const string& pattern, route_handler handler) {
+        if (pattern.empty() || pattern.data()[0] != '/') {
+            Exception(RouteError("route pattern must start with '/'"));
+        }
+        __route_tree* tree = nullptr;
+        for (auto& candidate : trees_) {
+            if (candidate.method == method) tree = &candidate;
+        }
+        if (tree == nullptr) {
+            trees_.emplace_back();
+            tree = &trees_.back();
+            tree->method = method;
+            tree->root = _MSTL make_unique<__route_node>();
+        }
+
+        __route_node* node = insert(tree->root.get(), string_view(pattern.data(), pattern.size()));
+        if (node->routable) {
+            Exception(RouteError("route registered twice"));
+        }
+        node->handler = _MSTL move(handler);
+        node->routable = true;
+    }
+
+    // handler for method and path, captures receive the path variables in pattern order.
+    const route_handler* find(const string_view method, const string_view path, route_captures& captures) const {
+        const __route_tree* tree = find_tree(method);
+        if (tree == nullptr) return nullptr;
+        const __route_node* node = match(tree->root.get(), path, captures);
+        return node ? &node->handler : nullptr;
+    }
+
+    MSTL_NODISCARD bool empty() const noexcept {
+        return trees_.empty();
+    }
+};
+
+MSTL_END_NAMESPACE__
+#endif // MSTL_ROUTER_HPP__
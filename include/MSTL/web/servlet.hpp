@@ -2,10 +2,18 @@
 #define MSTL_SERVLET_HPP__
 #include "socket.hpp"
 #include "session.hpp"
+#include "http_parser.hpp"
+#include "http_writer.hpp"
+#include "static_file.hpp"
+#include "router.hpp"
 #include "MSTL/core/print.hpp"
 #ifdef MSTL_PLATFORM_LINUX__
 #include <netinet/in.h>
 #include <unistd.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <cerrno>
 #endif
 MSTL_BEGIN_NAMESPACE__
 
@@ -18,17 +26,118 @@ private:
     HTTP_METHOD method = HTTP_METHOD::GET;
     string path = "/";
     string version = "HTTP/1.1";
-    unordered_map<string, string> headers;
-    unordered_map<string, string> cookies;
-    unordered_map<string, string> parameters; // query + body parameters
-    string query{};
-    string body{};
-    session* session = nullptr;
+    // views into the connection buffer, valid while the request is being handled.
+    // strings are only built the first time a handler asks for them.
+    vector<pair<string_view, string_view>> header_views;
+    string_view query_view{};
+    string_view body_view{};
+    mutable unordered_map<string, string> headers;
+    mutable unordered_map<string, string> cookies;
+    mutable unordered_map<string, string> parameters; // query + body parameters
+    mutable string query{};
+    mutable string body{};
+    mutable uint8_t materialized = 0;
+    route_captures path_variables;
+    shared_ptr<session> session{};  // keeps the session alive while the request runs
+
+    enum : uint8_t {
+        HEADERS_READY = 1, COOKIES_READY = 2, PARAMETERS_READY = 4,
+        QUERY_READY = 8, BODY_READY = 16
+    };
 
     friend class servlet;
+    friend class static_handler;
 
     static MSTL_API const string EMPTY_MARK;
 
+    static bool equal_ignore_case(const string_view lh, const string_view rh) noexcept {
+        return lh.size() == rh.size() &&
+            _MSTL memory_compare_ignore_case(lh.data(), rh.data(), lh.size()) == 0;
+    }
+
+    static string_view trim_view(string_view view) noexcept {
+        while (!view.empty() && _MSTL is_space(view.data()[0])) view.remove_prefix(1);
+        while (!view.empty() && _MSTL is_space(view.data()[view.size() - 1])) view.remove_suffix(1);
+        return view;
+    }
+
+    static int hex_value(const char c) noexcept {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static string url_decode(const string_view str) {
+        string result;
+        result.reserve(str.size());
+        const char* data = str.data();
+        for (size_t i = 0; i < str.size(); ++i) {
+            if (data[i] == '%' && i + 2 < str.size()) {
+                const int high = hex_value(data[i + 1]);
+                const int low = hex_value(data[i + 2]);
+                if (high >= 0 && low >= 0) {
+                    result += static_cast<char>(high << 4 | low);
+                    i += 2;
+                    continue;
+                }
+                result += data[i];
+            } else if (data[i] == '+') {
+                result += ' ';
+            } else {
+                result += data[i];
+            }
+        }
+        return result;
+    }
+
+    static void parse_url_encoded(string_view data, unordered_map<string, string>& params) {
+        while (!data.empty()) {
+            size_t end = data.find('&');
+            if (end == string_view::npos) end = data.size();
+            const string_view pair = data.substr(0, end);
+            const size_t eq_pos = pair.find('=');
+            if (eq_pos != string_view::npos) {
+                params[url_decode(pair.substr(0, eq_pos))] = url_decode(pair.substr(eq_pos + 1));
+            }
+            data.remove_prefix(end == data.size() ? end : end + 1);
+        }
+    }
+
+    void materialize_headers() const {
+        if (materialized & HEADERS_READY) return;
+        for (const auto& header : header_views) {
+            headers[string(header.first)] = string(header.second);
+        }
+        materialized |= HEADERS_READY;
+    }
+
+    void materialize_cookies() const {
+        if (materialized & COOKIES_READY) return;
+        materialized |= COOKIES_READY;
+        string_view cookie_header = get_header_view("Cookie");
+        while (!cookie_header.empty()) {
+            size_t end = cookie_header.find(';');
+            if (end == string_view::npos) end = cookie_header.size();
+            const string_view pair = cookie_header.substr(0, end);
+            const size_t eq_pos = pair.find('=');
+            if (eq_pos != string_view::npos) {
+                cookies[string(trim_view(pair.substr(0, eq_pos)))] =
+                    string(trim_view(pair.substr(eq_pos + 1)));
+            }
+            cookie_header.remove_prefix(end == cookie_header.size() ? end : end + 1);
+        }
+    }
+
+    void materialize_parameters() const {
+        if (materialized & PARAMETERS_READY) return;
+        materialized |= PARAMETERS_READY;
+        parse_url_encoded(get_query_view(), parameters);
+        if (method.is_post() && get_content_type_view().find(HTTP_CONTENT::FORM_APP) == 0) {
+            parse_url_encoded(get_body_view(), parameters);
+        }
+    }
+
 public:
     http_request() = default;
     http_request(const http_request&) = delete;
@@ -45,42 +154,76 @@ public:
     }
 
     void set_parameter(const string& name, const string& value) {
+        materialize_parameters();
         parameters[name] = value;
     }
     const string& get_parameter(const string& name) const {
+        materialize_parameters();
         auto it = parameters.find(name);
         return it != parameters.end() ? it->second : EMPTY_MARK;
     }
 
     void set_cookie(const string& name, const string& value) {
+        materialize_cookies();
         cookies[name] = value;
     }
     const string& get_cookie(const string& name) const {
+        materialize_cookies();
         auto it = cookies.find(name);
         return it != cookies.end() ? it->second : EMPTY_MARK;
     }
 
-    void set_session(class session* session) {
-        this->session = session;
+    // captures of the matched route pattern, ":id" in "/users/:id" is read as get_path_variable("id")
+    const string& get_path_variable(const string& name) const {
+        for (const auto& variable : path_variables) {
+            if (variable.first == name) return variable.second;
+        }
+        return EMPTY_MARK;
+    }
+    const route_captures& get_path_variables() const {
+        return path_variables;
+    }
+
+    void set_session(shared_ptr<class session> session) {
+        this->session = _MSTL move(session);
     }
     class session* get_session() const {
-        return session;
+        return session.get();
     }
 
     void set_header(const string& name, const string& value) {
+        materialize_headers();
         headers[name] = value;
     }
     const string& get_header(const string& name) const {
+        materialize_headers();
         auto it = headers.find(name);
         return it != headers.end() ? it->second : EMPTY_MARK;
     }
+    // header names compare case-insensitively, no allocation
+    string_view get_header_view(const string_view name) const {
+        if (materialized & HEADERS_READY) {
+            for (auto iter = headers.begin(); iter != headers.end(); ++iter) {
+                if (equal_ignore_case(string_view(iter->first.data(), iter->first.size()), name))
+                    return {iter->second.data(), iter->second.size()};
+            }
+            return {};
+        }
+        for (const auto& header : header_views) {
+            if (equal_ignore_case(header.first, name)) return header.second;
+        }
+        return {};
+    }
 
     void set_content_type(const string& value) {
-        cookies["Content-Type"] = value;
+        set_header("Content-Type", value);
     }
     const string& get_content_type() const {
         return get_header("Content-Type");
     }
+    string_view get_content_type_view() const {
+        return get_header_view("Content-Type");
+    }
     const string& get_cookie() const {
         return get_header("Cookie");
     }
@@ -104,21 +247,36 @@ public:
 
     void set_query(string query) {
         this->query = _MSTL move(query);
+        materialized |= QUERY_READY;
     }
     const string& get_query() const {
+        if (!(materialized & QUERY_READY)) {
+            query = string(query_view);
+            materialized |= QUERY_READY;
+        }
         return query;
     }
+    string_view get_query_view() const {
+        return materialized & QUERY_READY ? string_view(query.data(), query.size()) : query_view;
+    }
 
     const string& get_body() const {
+        if (!(materialized & BODY_READY)) {
+            body = string(body_view);
+            materialized |= BODY_READY;
+        }
         return body;
     }
+    string_view get_body_view() const {
+        return materialized & BODY_READY ? string_view(body.data(), body.size()) : body_view;
+    }
     void set_body(string body) {
         this->body = _MSTL move(body);
+        materialized |= BODY_READY;
     }
 
     bool is_https() const {
-        auto proto_header = get_header("X-Forwarded-Proto");
-        return proto_header == "https";
+        return get_header_view("X-Forwarded-Proto") == string_view("https");
     }
 };
 
@@ -131,6 +289,10 @@ private:
     unordered_map<string, string> headers;
     vector<cookie> cookies;
     string body{};
+    shared_ptr<file> body_file{};
+    shared_ptr<mapped_file> body_mapping{};
+    size_t body_offset = 0;
+    size_t body_length = 0;
     string redirect_url{};
     string forward_path{};
 
@@ -142,7 +304,6 @@ public:
     http_response() {
         set_content_type(HTTP_CONTENT::HTML_TEXT);
         set_content_encode("utf-8");
-        set_header("Connection", "close");
     }
 
     http_response(const http_response&) = delete;
@@ -228,11 +389,43 @@ public:
 
     void set_body(string body) {
         this->body = _MSTL move(body);
+        body_file.reset();
+        body_mapping.reset();
     }
     const string& get_body() const {
         return body;
     }
 
+    // the body is sent straight from the file, on linux without passing through user space.
+    bool set_body_file(file source, const size_t offset = 0, size_t length = static_cast<size_t>(-1)) {
+        if (!source.opened()) return false;
+        const size_t file_size = source.size();
+        if (offset > file_size) return false;
+        length = _MSTL min(length, file_size - offset);
+        set_body("");
+        body_file = _MSTL make_shared<file>(_MSTL move(source));
+        body_offset = offset;
+        body_length = length;
+        return true;
+    }
+    // the body is sent from a shared memory mapping, which stays alive until written.
+    bool set_body_mapping(shared_ptr<mapped_file> mapping, const size_t offset = 0,
+        size_t length = static_cast<size_t>(-1)) {
+        if (!mapping || offset > mapping->size()) return false;
+        length = _MSTL min(length, mapping->size() - offset);
+        set_body("");
+        body_mapping = _MSTL move(mapping);
+        body_offset = offset;
+        body_length = length;
+        return true;
+    }
+    bool has_body_file() const {
+        return static_cast<bool>(body_file);
+    }
+    size_t get_body_length() const {
+        return body_file || body_mapping ? body_length : body.size();
+    }
+
 
     void redirect(string url) {
         redirect_url = _MSTL move(url);
@@ -340,6 +533,164 @@ public:
 };
 
 
+// serves files below root for request paths starting with prefix.
+// paths without a matching file fall through to the servlet handlers.
+class static_handler {
+private:
+    string prefix_{};
+    string root_{};
+    static_file_cache* cache_ = nullptr;
+
+    static bool is_safe_path(const string& path) {
+        if (path.find('\0') != string::npos || path.find('\\') != string::npos) return false;
+        size_t start = 0;
+        while (start <= path.size()) {
+            size_t end = path.find('/', start);
+            if (end == string::npos) end = path.size();
+            if (end - start == 2 && path[start] == '.' && path[start + 1] == '.') return false;
+            start = end + 1;
+        }
+        return true;
+    }
+
+    static bool not_modified(const http_request& request, const static_file_cache::entry& file) {
+        const string_view if_none_match = request.get_header_view("If-None-Match");
+        if (!if_none_match.empty()) {
+            return if_none_match == string_view("*") ||
+                if_none_match.find(string_view(file.etag.data(), file.etag.size())) != string_view::npos;
+        }
+        ::time_t since;
+        const string_view if_modified_since = request.get_header_view("If-Modified-Since");
+        return !if_modified_since.empty() && http_date_parse(if_modified_since, since) && file.mtime <= since;
+    }
+
+    enum class RANGE_RESULT {
+        FULL,          // no usable range, the whole file is sent
+        PARTIAL,
+        UNSATISFIABLE  // a valid range starting past the end
+    };
+
+    // single "bytes=" range. ranges that are invalid or ask for several parts are ignored.
+    static RANGE_RESULT parse_range(string_view range, const size_t size, size_t& offset, size_t& length) {
+        const string_view unit("bytes=");
+        if (range.size() <= unit.size() || range.substr(0, unit.size()) != unit) return RANGE_RESULT::FULL;
+        range.remove_prefix(unit.size());
+        const size_t dash = range.find('-');
+        if (dash == string_view::npos || range.find(',') != string_view::npos) return RANGE_RESULT::FULL;
+
+        // positions past size_t saturate, they are past the end of any file anyway
+        const auto number = [](const string_view digits, size_t& value, bool& valid) {
+            value = 0;
+            if (digits.empty()) return false;
+            for (size_t i = 0; i < digits.size(); ++i) {
+                if (!_MSTL is_digit(digits.data()[i])) {
+                    valid = false;
+                    return false;
+                }
+                const size_t digit = digits.data()[i] - '0';
+                value = value > (static_cast<size_t>(-1) - digit) / 10 ? static_cast<size_t>(-1) : value * 10 + digit;
+            }
+            return true;
+        };
+        size_t first, last;
+        bool valid = true;
+        const bool has_first = number(range.substr(0, dash), first, valid);
+        const bool has_last = number(range.substr(dash + 1), last, valid);
+        if (!valid || (!has_first && !has_last) || (has_first && has_last && last < first)) {
+            return RANGE_RESULT::FULL;
+        }
+        if (has_first) {
+            if (first >= size) return RANGE_RESULT::UNSATISFIABLE;
+            if (!has_last || last >= size) last = size - 1;
+        } else {
+            if (last == 0 || size == 0) return RANGE_RESULT::UNSATISFIABLE;
+            first = last >= size ? 0 : size - last;
+            last = size - 1;
+        }
+        offset = first;
+        length = last - first + 1;
+        return RANGE_RESULT::PARTIAL;
+    }
+
+public:
+    static_handler() = default;
+    static_handler(string prefix, string root, static_file_cache* cache)
+        : prefix_(_MSTL move(prefix)), root_(_MSTL move(root)), cache_(cache) {
+        if (!root_.empty() && root_.ends_with("/")) root_.erase(root_.size() - 1, 1);
+    }
+
+    // the prefix has to end on a segment boundary, /static does not take /staticfoo.
+    bool matches(const string& path) const {
+        if (path.size() < prefix_.size() ||
+            _MSTL memory_compare(path.data(), prefix_.data(), prefix_.size()) != 0) return false;
+        return path.size() == prefix_.size() || prefix_.ends_with("/") || path[prefix_.size()] == '/';
+    }
+
+    // returns false when there is no such file and the request should go on.
+    bool handle(const http_request& request, http_response& response) const {
+        const HTTP_METHOD& method = request.get_method();
+        if (!method.is_get() && !method.is_head()) return false;
+
+        string relative = http_request::url_decode(string_view(
+            request.get_path().data() + prefix_.size(), request.get_path().size() - prefix_.size()));
+        if (!relative.starts_with("/")) relative = "/" + relative;
+        if (relative.ends_with("/")) relative += "index.html";
+        if (!is_safe_path(relative)) {
+            response.set_status(HTTP_STATUS::S4_FORBIDDEN);
+            response.set_status_msg("Forbidden");
+            return true;
+        }
+
+        const auto entry = cache_->lookup(root_ + relative);
+        if (!entry) return false;
+
+        response.set_header("Content-Type", http_mime_type(string_view(relative.data(), relative.size())));
+        response.set_header("ETag", entry->etag);
+        response.set_header("Last-Modified", entry->last_modified);
+        response.set_header("Accept-Ranges", "bytes");
+        if (not_modified(request, *entry)) {
+            response.set_status(HTTP_STATUS::S3_NO_MODIFIED);
+            response.set_status_msg("Not Modified");
+            return true;
+        }
+
+        size_t offset = 0;
+        size_t length = entry->size;
+        const string_view range = request.get_header_view("Range");
+        const string_view if_range = request.get_header_view("If-Range");
+        RANGE_RESULT ranged = RANGE_RESULT::FULL;
+        if (!range.empty() && (if_range.empty() ||
+            if_range == string_view(entry->etag.data(), entry->etag.size()))) {
+            ranged = parse_range(range, entry->size, offset, length);
+        }
+        if (ranged == RANGE_RESULT::UNSATISFIABLE) {
+            response.set_status(HTTP_STATUS::S4_RANGE_NOT_SATISFIABLE);
+            response.set_status_msg("Range Not Satisfiable");
+            response.set_header("Content-Range", "bytes */" + _MSTL to_string(entry->size));
+            return true;
+        }
+        if (ranged == RANGE_RESULT::PARTIAL) {
+            response.set_status(HTTP_STATUS::S2_PARTIAL_CONTENT);
+            response.set_status_msg("Partial Content");
+            response.set_header("Content-Range", "bytes " + _MSTL to_string(offset) + "-" +
+                _MSTL to_string(offset + length - 1) + "/" + _MSTL to_string(entry->size));
+        } else {
+            response.set_ok();
+            response.set_status_msg("OK");
+        }
+
+        if (method.is_head()) {
+            response.set_header("Content-Length", _MSTL to_string(length));
+        } else if (entry->mapping) {
+            response.set_body_mapping(entry->mapping, offset, length);
+        } else if (!response.set_body_file(file(entry->path, FILE_ACCESS::READ), offset, length)) {
+            return false;
+        }
+        return true;
+    }
+};
+
+
 struct HTTP_COOKIE {
     static constexpr auto JSESSIONID = "JSESSIONID";
     static constexpr auto SESSIONID = "SESSIONID";
@@ -348,6 +699,12 @@ struct HTTP_COOKIE {
 };
 
 
+enum class SERVLET_MODE {
+    MODE_BLOCKING,  // one blocking connection per worker
+    MODE_REACTOR    // edge-triggered epoll loop per worker, linux only
+};
+
+
 class servlet {
 private:
     socket server_socket_{};
@@ -362,10 +719,36 @@ private:
     __session_manager session_manager_;
     filter_chain filter_chain_;
     string session_cookie_name_ = HTTP_COOKIE::JSESSIONID;
+    SERVLET_MODE mode_ = SERVLET_MODE::MODE_BLOCKING;
+    vector<static_handler> static_handlers_;
+    http_router router_;
+    static_file_cache static_cache_;
+#ifdef MSTL_PLATFORM_LINUX__
+    int wakeup_fd_ = -1;
+#endif
+    bool keep_alive_ = true;
+    uint32_t keep_alive_timeout_ = 5;  // seconds
+    size_t max_keep_alive_requests_ = 100;
+    size_t max_body_size_ = 1024 * 1024 * 8;
+
+    static constexpr size_t MAX_HEADER_SIZE = 1024 * 16;
+    // a client this far behind on reading its responses is not read from until they drain
+    static constexpr size_t MAX_QUEUED_OUTPUT = 1024 * 1024;
+    static constexpr size_t READ_BUDGET = 1024 * 64;  // per reactor read round
+    static constexpr auto BAD_REQUEST_RESPONSE =
+        "HTTP/1.1 400 Bad Request\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
+    static constexpr auto PAYLOAD_TOO_LARGE_RESPONSE =
+        "HTTP/1.1 413 Payload Too Large\r\nContent-Length: 0\r\nConnection: close\r\n\r\n";
 
 private:
     void start_workers(const int thread_count) {
         for (int i = 0; i < thread_count; ++i) {
+#ifdef MSTL_PLATFORM_LINUX__
+            if (mode_ == SERVLET_MODE::MODE_REACTOR) {
+                worker_threads_.emplace_back(&servlet::reactor_loop, this);
+                continue;
+            }
+#endif
             worker_threads_.emplace_back(&servlet::accept_conns, this);
         }
     }
@@ -397,8 +780,120 @@ private:
         }
     }
 
+    // a blocking worker stays with its connection until the client closes it or it idles out.
     void handle_client(const socket::socket_t client_socket) {
-        http_request request = parse_request(client_socket);
+        set_receive_timeout(client_socket);
+
+        char buffer[4096];
+        http_parser parser(MAX_HEADER_SIZE, max_body_size_);
+        string input;
+        http_writer writer;
+        size_t consumed = 0;
+        size_t served = 0;
+        while (running_) {
+            const HTTP_PARSE_STATUS status = parser.parse(input.data() + consumed, input.size() - consumed);
+            if (status == HTTP_PARSE_STATUS::INCOMPLETE) {
+                // pipelined responses already built go out in one send
+                if (!writer.empty() && writer.flush(client_socket) != HTTP_WRITE_STATUS::DONE) return;
+                if (consumed != 0) {
+                    input.erase(0, consumed);
+                    consumed = 0;
+                }
+#ifdef MSTL_PLATFORM_WINDOWS__
+                int bytes_read = ::recv(client_socket, buffer, sizeof(buffer), 0);
+#elif defined(MSTL_PLATFORM_LINUX__)
+                ssize_t bytes_read = ::read(client_socket, buffer, sizeof(buffer));
+#endif
+                if (bytes_read <= 0) return;
+                input.append(buffer, bytes_read);
+                continue;
+            }
+            if (status != HTTP_PARSE_STATUS::COMPLETE) {
+                append_parse_error(status, writer);
+                writer.flush(client_socket);
+                return;
+            }
+
+            const bool keep_alive = serve_request(parser, input.data() + consumed, served++, writer);
+            consumed += parser.request_size();
+            parser.reset();
+            if (!keep_alive) {
+                writer.flush(client_socket);
+                return;
+            }
+            if (writer.queued() >= MAX_QUEUED_OUTPUT && writer.flush(client_socket) != HTTP_WRITE_STATUS::DONE) return;
+        }
+    }
+
+    static void append_parse_error(const HTTP_PARSE_STATUS status, http_writer& writer) {
+        const char* response = status == HTTP_PARSE_STATUS::BODY_TOO_LARGE ?
+            PAYLOAD_TOO_LARGE_RESPONSE : BAD_REQUEST_RESPONSE;
+        writer.append_head(response, string_length(response));
+    }
+
+    void set_receive_timeout(const socket::socket_t client_socket) const {
+#ifdef MSTL_PLATFORM_WINDOWS__
+        const DWORD timeout = keep_alive_timeout_ * 1000;
+        ::setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO,
+            reinterpret_cast<const char*>(&timeout), sizeof(timeout));
+#elif defined(MSTL_PLATFORM_LINUX__)
+        ::timeval timeout{};
+        timeout.tv_sec = keep_alive_timeout_;
+        ::setsockopt(client_socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+#endif
+    }
+
+    // parses and handles one framed request, queueing the response on the writer.
+    // returns whether the connection should stay open.
+    bool serve_request(const http_parser& parser, const char* data, const size_t served, http_writer& writer) {
+        http_request request = parse_request(parser, data);
+        http_response response = process_request(request);
+        const bool keep_alive = keep_connection(request, response, served + 1);
+        write_response(response, writer);
+        return keep_alive;
+    }
+
+    void write_response(http_response& response, http_writer& writer) {
+        build_response_head(response, writer.head());
+        writer.commit_head();
+        if (!response.get_redirect().empty()) return;
+        if (response.body_file) {
+            writer.append_file(_MSTL move(response.body_file),
+                response.body_offset, response.body_length);
+        } else if (response.body_mapping) {
+            writer.append_mapping(_MSTL move(response.body_mapping),
+                response.body_offset, response.body_length);
+        } else {
+            writer.append_body(_MSTL move(response.body));
+        }
+    }
+
+    bool keep_connection(const http_request& request, http_response& response, const size_t served) const {
+        bool keep = keep_alive_ && served < max_keep_alive_requests_;
+        if (keep) {
+            const string_view connection = request.get_header_view("Connection");
+            if (request.get_version() == "HTTP/1.0") {
+                keep = http_request::equal_ignore_case(connection, "keep-alive");
+            } else {
+                keep = !http_request::equal_ignore_case(connection, "close");
+            }
+        }
+        if (keep && _MSTL string_compare_ignore_case(
+            response.get_header("Connection").c_str(), "close") == 0) {
+            keep = false;
+        }
+
+        if (keep) {
+            response.set_header("Connection", "keep-alive");
+            response.set_header("Keep-Alive", "timeout=" + _MSTL to_string(keep_alive_timeout_) +
+                ", max=" + _MSTL to_string(max_keep_alive_requests_ - served));
+        } else {
+            response.set_header("Connection", "close");
+        }
+        return keep;
+    }
+
+    http_response process_request(http_request& request) {
         int forward_count = 0;
         do {
             constexpr int MAX_FORWARD = 5;
@@ -408,273 +903,347 @@ private:
                 forward_count++;
                 continue;
             }
-            send_response(client_socket, response);
-            return;
+            return response;
         } while (true);
     }
 
-    static void parse_cookies(const string &cookie_header, http_request &request) {
-        if (cookie_header.empty())
-            return;
-
-        vector<string> cookie_pairs;
-        size_t start = 0;
-        size_t end = cookie_header.find(';');
-
-        while (end != string::npos) {
-            cookie_pairs.push_back(cookie_header.substr(start, end - start).trim());
-            start = end + 1;
-            end = cookie_header.find(';', start);
+#ifdef MSTL_PLATFORM_LINUX__
+    struct __reactor_connection {
+        socket::socket_t fd;
+        string input{};
+        http_parser parser;
+        http_writer writer{};
+        size_t served = 0;
+        bool closing = false;
+        bool readable = false;     // the socket may hold bytes not read yet
+        bool peer_closed = false;  // the client sent EOF, close once its input is answered
+        std::chrono::steady_clock::time_point last_active;
+        __reactor_connection* prev = nullptr;
+        __reactor_connection* next = nullptr;
+
+        __reactor_connection(const socket::socket_t fd, const size_t max_body_size)
+            : fd(fd), parser(MAX_HEADER_SIZE, max_body_size) {}
+    };
+
+    // connections are kept in most recently active first order, so idle ones collect at the tail.
+    struct __reactor {
+        int epoll_fd = -1;
+        __reactor_connection* connections = nullptr;
+        __reactor_connection* tail = nullptr;
+
+        void push_front(__reactor_connection* conn) {
+            conn->prev = nullptr;
+            conn->next = connections;
+            if (connections) connections->prev = conn;
+            else tail = conn;
+            connections = conn;
         }
-        cookie_pairs.push_back(cookie_header.substr(start).trim());
 
-        for (const auto &pair: cookie_pairs) {
-            const size_t eq_pos = pair.find('=');
-            if (eq_pos != string::npos) {
-                string name = pair.substr(0, eq_pos).trim();
-                string value = pair.substr(eq_pos + 1).trim();
-                request.set_cookie(name, value);
-            }
+        void unlink(__reactor_connection* conn) {
+            if (conn->prev) conn->prev->next = conn->next;
+            else connections = conn->next;
+            if (conn->next) conn->next->prev = conn->prev;
+            else tail = conn->prev;
+            conn->prev = conn->next = nullptr;
         }
-    }
 
-    static void parse_parameters(http_request &request) {
-        if (!request.get_query().empty()) {
-            parse_url_encoded(request.get_query(), request.parameters);
+        void touch(__reactor_connection* conn) {
+            conn->last_active = std::chrono::steady_clock::now();
+            if (connections == conn) return;
+            unlink(conn);
+            push_front(conn);
         }
-        if (request.get_method().is_post() && !request.get_body().empty()) {
-            string content_type = request.get_content_type();
-            if (content_type.find(HTTP_CONTENT::FORM_APP) == 0) {
-                parse_url_encoded(request.get_body(), request.parameters);
-            }
+    };
+
+    void reactor_loop() {
+        constexpr int MAX_EVENTS = 256;
+        __reactor reactor;
+        reactor.epoll_fd = ::epoll_create1(EPOLL_CLOEXEC);
+        if (reactor.epoll_fd < 0) {
+            perror("epoll_create1 failed");
+            return;
         }
-    }
 
-    static void parse_url_encoded(const string &data, unordered_map<string, string> &params) {
-        if (data.empty())
+        // every worker watches the listen socket, EPOLLEXCLUSIVE avoids waking them all
+        ::epoll_event event{};
+        event.events = EPOLLIN;
+#ifdef EPOLLEXCLUSIVE
+        event.events |= EPOLLEXCLUSIVE;
+#endif
+        event.data.ptr = nullptr;
+        if (::epoll_ctl(reactor.epoll_fd, EPOLL_CTL_ADD, server_socket_.get(), &event) < 0) {
+            perror("epoll_ctl failed");
+            ::close(reactor.epoll_fd);
             return;
-
-        vector<string> pairs;
-        size_t start = 0;
-        size_t end = data.find('&');
-
-        while (end != string::npos) {
-            pairs.push_back(data.substr(start, end - start));
-            start = end + 1;
-            end = data.find('&', start);
         }
-        pairs.push_back(data.substr(start));
+        event.events = EPOLLIN;
+        event.data.ptr = &wakeup_fd_;
+        ::epoll_ctl(reactor.epoll_fd, EPOLL_CTL_ADD, wakeup_fd_, &event);
 
-        for (const auto &pair: pairs) {
-            const size_t eq_pos = pair.find('=');
-            if (eq_pos != string::npos) {
-                string name = url_decode(pair.substr(0, eq_pos));
-                string value = url_decode(pair.substr(eq_pos + 1));
-                params[name] = value;
+        ::epoll_event events[MAX_EVENTS];
+        while (running_) {
+            const int ready = ::epoll_wait(reactor.epoll_fd, events, MAX_EVENTS, 1000);
+            if (ready < 0) {
+                if (errno == EINTR) continue;
+                perror("epoll_wait failed");
+                break;
             }
-        }
-    }
-
-    static string url_decode(const string& str) {
-        string result;
-        for (size_t i = 0; i < str.length(); ++i) {
-            if (str[i] == '%' && i + 2 < str.length()) {
-                try {
-                    hexadecimal hex_val(str.substr(i + 1, 2));
-                    result += static_cast<char>(hex_val.to_decimal());
-                } catch (...) {
-                    result += str[i];
+            for (int i = 0; i < ready; ++i) {
+                void* tag = events[i].data.ptr;
+                if (tag == &wakeup_fd_) continue;
+                if (tag == nullptr) {
+                    reactor_accept(reactor);
+                    continue;
+                }
+                auto* conn = static_cast<__reactor_connection*>(tag);
+                reactor.touch(conn);
+                if (!reactor_serve(conn, events[i].events)) {
+                    reactor_close(reactor, conn);
                 }
-            } else if (str[i] == '+') {
-                result += ' ';
-            } else {
-                result += str[i];
             }
+            // swept only after dispatch, events[] may still point at an idle connection
+            reactor_sweep(reactor);
         }
-        return result;
-    }
 
-protected:
-    virtual http_request parse_request(const socket::socket_t client_socket) {
-        http_request req;
-        char buffer[4096];
-        string request_data;
+        while (reactor.connections) {
+            reactor_close(reactor, reactor.connections);
+        }
+        ::close(reactor.epoll_fd);
+    }
 
-        ssize_t total_read = 0;
+    void reactor_accept(__reactor& reactor) {
         while (true) {
-#ifdef MSTL_PLATFORM_WINDOWS__
-            int bytes_read = ::recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-#elif defined(MSTL_PLATFORM_LINUX__)
-            ssize_t bytes_read = ::read(client_socket, buffer, sizeof(buffer) - 1);
-#endif
-            if (bytes_read <= 0) break;
-
-            buffer[bytes_read] = '\0';
-            request_data.append(buffer, bytes_read);
-            total_read += bytes_read;
-
-            const size_t header_end = request_data.find("\r\n\r\n");
-            if (header_end != string::npos) {
-                size_t content_length = 0;
-                const size_t content_start = header_end + 4;
-
-                const size_t cl_pos = request_data.find("Content-Length:");
-                if (cl_pos != string::npos) {
-                    const size_t cl_end = request_data.find("\r\n", cl_pos);
-                    if (cl_end != string::npos) {
-                        string cl_str = request_data.substr(
-                            cl_pos + 15, cl_end - cl_pos - 15
-                            ).trim();
-                        content_length = _MSTL to_uint32(cl_str.c_str());
-                    }
+            const socket::socket_t client_socket = ::accept4(server_socket_.get(),
+                nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (client_socket == socket::INVALID_MARK) {
+                if (errno == EINTR) continue;
+                if (errno != EAGAIN && errno != EWOULDBLOCK && running_) {
+                    perror("accept failed");
                 }
+                return;
+            }
 
-                const auto body_read = static_cast<ssize_t>(total_read - content_start);
-                if (body_read < static_cast<ssize_t>(content_length)) {
-                    ssize_t remaining = static_cast<ssize_t>(content_length - body_read);
-                    while (remaining > 0) {
-                        bytes_read = ::read(client_socket, buffer,
-                            _MSTL min(static_cast<ssize_t>(sizeof(buffer)), remaining));
-                        if (bytes_read <= 0) break;
-                        request_data.append(buffer, bytes_read);
-                        remaining -= bytes_read;
-                    }
-                }
-                break;
+            auto* conn = new __reactor_connection(client_socket, max_body_size_);
+            // EPOLLOUT is registered once, edge-triggered it only fires when the send buffer drains
+            ::epoll_event event{};
+            event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+            event.data.ptr = conn;
+            if (::epoll_ctl(reactor.epoll_fd, EPOLL_CTL_ADD, client_socket, &event) < 0) {
+                perror("epoll_ctl failed");
+                ::close(client_socket);
+                delete conn;
+                continue;
             }
+            conn->last_active = std::chrono::steady_clock::now();
+            reactor.push_front(conn);
+        }
+    }
+
+    static void reactor_close(__reactor& reactor, __reactor_connection* conn) {
+        reactor.unlink(conn);
+        ::close(conn->fd);
+        delete conn;
+    }
 
-            if (total_read > 1024 * 16) break;
+    void reactor_sweep(__reactor& reactor) const {
+        const auto deadline = std::chrono::steady_clock::now() -
+            std::chrono::seconds(keep_alive_timeout_);
+        while (reactor.tail && reactor.tail->last_active < deadline) {
+            reactor_close(reactor, reactor.tail);
         }
+    }
 
-        istringstream iss(request_data);
-        string line;
-        if (iss.getline(line)) {
-            line.trim();
-            const size_t pos1 = line.find(' ');
-            if (pos1 != string::npos) {
-                req.set_method(line.substr(0, pos1));
-                const size_t pos2 = line.find(' ', pos1 + 1);
-                if (pos2 != string::npos) {
-                    req.set_path(line.substr(pos1 + 1, pos2 - pos1 - 1));
-                    req.set_version(line.substr(pos2 + 1));
-                }
+    // reads, answers and sends in turns. while too much output is queued the
+    // input stays in the socket and the next EPOLLOUT edge resumes the work.
+    bool reactor_serve(__reactor_connection* conn, const uint32_t events) {
+        if (events & EPOLLERR) return false;
+        if (events & (EPOLLIN | EPOLLRDHUP | EPOLLHUP)) conn->readable = true;
+        while (true) {
+            if (!conn->closing && conn->writer.queued() < MAX_QUEUED_OUTPUT) {
+                if (conn->readable && !reactor_read(conn)) return false;
+                reactor_process(conn);
+            }
+            if (conn->writer.empty()) {
+                if (conn->closing) return false;
+                if (!conn->readable) return true;
+                continue;
+            }
+            switch (conn->writer.flush(conn->fd)) {
+                case HTTP_WRITE_STATUS::DONE:
+                    if (conn->closing) return false;
+                    break;
+                case HTTP_WRITE_STATUS::AGAIN:
+                    return true;  // wait for the next EPOLLOUT edge
+                default:
+                    return false;
             }
         }
+    }
 
-        // url query
-        const size_t query_pos = req.get_path().find('?');
-        if (query_pos != string::npos) {
-            req.set_query(req.get_path().substr(query_pos+1));
-            req.set_path(req.get_path().substr(0, query_pos));
+    // reads until EAGAIN, as edge-triggered mode requires, or until the round's budget is spent.
+    static bool reactor_read(__reactor_connection* conn) {
+        char buffer[4096];
+        size_t budget = READ_BUDGET;
+        while (budget > 0) {
+            const ssize_t bytes_read = ::read(conn->fd, buffer, sizeof(buffer));
+            if (bytes_read > 0) {
+                conn->input.append(buffer, bytes_read);
+                budget -= _MSTL min(budget, static_cast<size_t>(bytes_read));
+                continue;
+            }
+            if (bytes_read == 0) {
+                conn->readable = false;
+                conn->peer_closed = true;
+                return true;
+            }
+            if (errno == EINTR) continue;
+            conn->readable = false;
+            return errno == EAGAIN || errno == EWOULDBLOCK;
         }
+        return true;
+    }
 
-        // request header
-        while (iss.getline(line)) {
-            line.trim();
-            if (line.empty()) break;
-
-            const size_t colon_pos = line.find(':');
-            if (colon_pos != string::npos) {
-                string key = line.substr(0, colon_pos).trim();
-                string value = line.substr(colon_pos+1).trim();
-                req.set_header(key, _MSTL move(value));
+    // answers the complete requests in the input buffer, responses queue up in order.
+    // stops early once the queued output reaches MAX_QUEUED_OUTPUT.
+    void reactor_process(__reactor_connection* conn) {
+        size_t consumed = 0;
+        bool drained = false;
+        while (conn->writer.queued() < MAX_QUEUED_OUTPUT) {
+            http_parser& parser = conn->parser;
+            const HTTP_PARSE_STATUS status = parser.parse(
+                conn->input.data() + consumed, conn->input.size() - consumed);
+            if (status == HTTP_PARSE_STATUS::INCOMPLETE) {
+                drained = true;
+                break;
+            }
+            if (status != HTTP_PARSE_STATUS::COMPLETE) {
+                append_parse_error(status, conn->writer);
+                conn->closing = true;
+                break;
             }
-        }
 
-        // request body
-        const size_t body_start = request_data.find("\r\n\r\n");
-        if (body_start != string::npos && body_start + 4 < request_data.size()) {
-            req.set_body(request_data.substr(body_start + 4));
+            bool keep_alive = false;
+            try {
+                keep_alive = serve_request(parser, conn->input.data() + consumed,
+                    conn->served++, conn->writer);
+            } catch (const Error& e) {
+                perror(e.what());
+            }
+            consumed += parser.request_size();
+            parser.reset();
+            if (!keep_alive) {
+                conn->closing = true;
+                break;
+            }
         }
+        // nothing more can arrive once the client sent EOF and its requests are answered
+        if (drained && conn->peer_closed) conn->closing = true;
+        // the unfinished request moves to the buffer front, the parser offsets stay relative to it
+        if (conn->closing) conn->input.clear();
+        else if (consumed != 0) conn->input.erase(0, consumed);
+    }
+#endif // MSTL_PLATFORM_LINUX__
 
-        // Parse cookies
-        auto cookie_str = req.get_cookie();
-        if (!cookie_str.empty()) {
-            parse_cookies(cookie_str, req);
+protected:
+    virtual http_request parse_request(const http_parser& parser, const char* data) {
+        http_request req;
+        req.set_method(string(parser.method().view(data)));
+        req.set_path(string(parser.path().view(data)));
+        req.set_version(string(parser.version().view(data)));
+        req.query_view = parser.query().view(data);
+        req.body_view = parser.body().view(data);
+
+        const auto& headers = parser.headers();
+        req.header_views.reserve(headers.size());
+        for (const auto& header : headers) {
+            req.header_views.emplace_back(header.name.view(data), header.value.view(data));
         }
 
-        // Parse parameters
-        parse_parameters(req);
-
         // Handle session
-        const string session_id = req.get_cookie(session_cookie_name_);
-        if (!session_id.empty() && session_manager_.session_exists(session_id)) {
-            req.set_session(session_manager_.get_session(session_id, false));
-        }
+        req.set_session(session_manager_.find_session(req.get_cookie(session_cookie_name_)));
 
         return req;
     }
 
-    virtual string build_response_str(const http_response& response) {
-        ostringstream ss;
-
+    virtual void build_response_head(const http_response& response, string& head) {
+        head += response.get_version();
         if (!response.get_redirect().empty()) {
-            ss << response.get_version() << " 302 Found\r\n";
-            ss << "Location: " << response.get_redirect() << "\r\n";
+            head += " 302 Found\r\nLocation: ";
+            head += response.get_redirect();
+            head += "\r\n";
         } else {
-            ss << response.get_version() << " "
-               << static_cast<uint16_t>(response.get_status()) << " "
-               << response.get_status_msg() << "\r\n";
+            head += ' ';
+            head += _MSTL to_string(static_cast<uint16_t>(response.get_status()));
+            head += ' ';
+            head += response.get_status_msg();
+            head += "\r\n";
         }
 
         for (const auto& cookie : response.cookies) {
-            ss << "Set-Cookie: " << cookie.to_string() << "\r\n";
+            head += "Set-Cookie: ";
+            head += cookie.to_string();
+            head += "\r\n";
         }
-        if (response.get_redirect().empty() &&
-            response.get_content_length().empty()) {
-            ss << "Content-Length: " << response.get_body().size() << "\r\n";
+        // a 304 carries no body and its Content-Length would describe the cached resource,
+        // a 204 must not have one at all
+        const bool bodiless = response.get_redirect().empty() &&
+            (response.get_status() == HTTP_STATUS::S3_NO_MODIFIED ||
+             response.get_status() == HTTP_STATUS::S2_NO_CONTENT);
+        if (!bodiless && response.get_content_length().empty()) {
+            head += "Content-Length: ";
+            head += _MSTL to_string(response.get_redirect().empty() ? response.get_body_length() : 0);
+            head += "\r\n";
         }
         for (auto iter = response.headers.begin(); iter != response.headers.end(); ++iter) {
-            ss << iter->first << ": " << iter->second << "\r\n";
+            head += iter->first;
+            head += ": ";
+            head += iter->second;
+            head += "\r\n";
         }
-        ss << "\r\n";
+        head += "\r\n";
+    }
 
-        if (!response.get_redirect().empty()) {
-        } else {
-            ss << response.get_body();
-        }
-        return ss.str();
+protected:
+    void add_filter(filter* filter) {
+        filter_chain_.add_filter(filter);
     }
 
-    void send_response(const socket::socket_t client_socket, const http_response& response) {
-        string response_str = build_response_str(response);
-        const char *data = response_str.data();
-        const size_t total = response_str.size();
-        size_t sent = 0;
+    // routes are tried before do_get/do_post, requests without a route still reach them.
+    void add_route(const HTTP_METHOD& method, const string& pattern, route_handler handler) {
+        router_.add(method.name(), pattern, _MSTL move(handler));
+    }
 
-        while (sent < total) {
-#ifdef MSTL_PLATFORM_WINDOWS__
-            int bytes_sent = ::send(client_socket, data + sent, static_cast<int>(total - sent), 0);
-#elif defined(MSTL_PLATFORM_LINUX__)
-            ssize_t bytes_sent = ::send(client_socket, data + sent, total - sent, 0);
-#endif
-            if (bytes_sent <= 0) {
-                perror("send failed");
-                break;
-            }
-            sent += bytes_sent;
+    bool dispatch_route(http_request& request, http_response& response) {
+        if (router_.empty()) return false;
+        const string& path = request.get_path();
+        const string_view path_view(path.data(), path.size());
+        const string& method = request.get_method().name();
+
+        request.path_variables.clear();
+        const route_handler* handler = router_.find(
+            string_view(method.data(), method.size()), path_view, request.path_variables);
+        const bool head_as_get = handler == nullptr && request.get_method().is_head();
+        if (head_as_get) {
+            handler = router_.find("GET", path_view, request.path_variables);
         }
+        if (handler == nullptr) return false;
+
+        (*handler)(request, response);
+        if (head_as_get) response.set_body("");
+        return true;
     }
 
-protected:
-    void add_filter(filter* filter) {
-        filter_chain_.add_filter(filter);
+    void add_static(string prefix, string root) {
+        static_handlers_.emplace_back(_MSTL move(prefix), _MSTL move(root), &static_cache_);
     }
 
     session* get_session(http_request& request, const bool create) {
-        session* session = request.get_session();
-        if (session) return session;
+        if (session* current = request.get_session()) return current;
+        if (!create) return nullptr;
 
-        string session_id = request.get_cookie(session_cookie_name_);
-        if (!session_id.empty()) {
-            session = session_manager_.get_session(session_id, false);
-        }
-
-        if (!session && create) {
-            session = session_manager_.create_session();
-        }
-        request.set_session(session);
-        return session;
+        // parse_request already looked the cookie up, only a new session is left
+        request.set_session(session_manager_.create_session());
+        return request.get_session();
     }
 
     session* get_session(http_request& request) {
@@ -706,6 +1275,16 @@ protected:
             return response;
         }
 
+        for (const auto& handler : static_handlers_) {
+            if (!handler.matches(request.get_path())) continue;
+            http_response file_response;
+            filter_chain_.execute_filters(request, file_response);
+            if (handler.handle(request, file_response)) {
+                filter_chain_.execute_post_filters(request, file_response);
+                return file_response;
+            }
+        }
+
         session* session = get_session(request, true);
         if (session) {
             add_session_cookie(request, response, session);
@@ -716,12 +1295,13 @@ protected:
         println(
             "[", request.get_method(), "]", request.get_path(),
             "Query:", request.get_query(),
-            "Body size:", request.get_body().size(),
+            "Body size:", request.get_body_view().size(),
             *request.get_session());
         print();
 
         const HTTP_METHOD& method = request.get_method();
-        if (method.is_get()) {
+        if (dispatch_route(request, response)) {
+        } else if (method.is_get()) {
             do_get(request, response);
         } else if (method.is_post()) {
             do_post(request, response);
@@ -784,6 +1364,7 @@ protected:
         ss << request.get_method().to_string() << " " << request.get_path();
         if (!request.get_query().empty()) ss << "?" << request.get_query();
         ss << " " << request.get_version() << "\r";
+        request.materialize_headers();
         for (auto iter = request.headers.begin(); iter != request.headers.end(); ++iter) {
             ss << iter->first << ": " << iter->second << "\r";
         }
@@ -855,6 +1436,21 @@ public:
             return false;
         }
 
+#ifdef MSTL_PLATFORM_LINUX__
+        if (mode_ == SERVLET_MODE::MODE_REACTOR) {
+            const int flags = ::fcntl(server_socket_.get(), F_GETFL, 0);
+            if (flags < 0 || ::fcntl(server_socket_.get(), F_SETFL, flags | O_NONBLOCK) < 0) {
+                perror("fcntl failed");
+                return false;
+            }
+            wakeup_fd_ = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+            if (wakeup_fd_ < 0) {
+                perror("eventfd failed");
+                return false;
+            }
+        }
+#endif
+
         running_ = true;
         start_workers(static_cast<int32_t>(thread_count));
         return true;
@@ -864,6 +1460,14 @@ public:
         if (!running_) return;
 
         running_ = false;
+#ifdef MSTL_PLATFORM_LINUX__
+        if (wakeup_fd_ >= 0) {
+            constexpr uint64_t signal = 1;
+            (void)::write(wakeup_fd_, &signal, sizeof(signal));
+        }
+        // wakes workers blocked in accept
+        ::shutdown(server_socket_.get(), SHUT_RDWR);
+#endif
         server_socket_.close();
 #ifdef MSTL_PLATFORM_WINDOWS__
         WSACleanup();
@@ -873,9 +1477,49 @@ public:
             if (t.joinable()) t.join();
         }
         worker_threads_.clear();
+#ifdef MSTL_PLATFORM_LINUX__
+        if (wakeup_fd_ >= 0) {
+            ::close(wakeup_fd_);
+            wakeup_fd_ = -1;
+        }
+#endif
         destroy();
     }
 
+    bool set_mode(const SERVLET_MODE mode) {
+        if (running_) return false;
+#ifndef MSTL_PLATFORM_LINUX__
+        if (mode == SERVLET_MODE::MODE_REACTOR) return false;
+#endif
+        mode_ = mode;
+        return true;
+    }
+    MSTL_NODISCARD SERVLET_MODE mode() const {
+        return mode_;
+    }
+
+    bool set_keep_alive(const bool keep_alive) {
+        if (running_) return false;
+        keep_alive_ = keep_alive;
+        return true;
+    }
+    bool set_keep_alive_timeout(const uint32_t seconds) {
+        if (running_ || seconds == 0) return false;
+        keep_alive_timeout_ = seconds;
+        return true;
+    }
+    bool set_max_keep_alive_requests(const size_t max_requests) {
+        if (running_ || max_requests == 0) return false;
+        max_keep_alive_requests_ = max_requests;
+        return true;
+    }
+    // requests declaring a longer body are answered with 413 and the connection is closed.
+    bool set_max_body_size(const size_t bytes) {
+        if (running_) return false;
+        max_body_size_ = bytes;
+        return true;
+    }
+
     void set_session_cookie_name(const char* name) {
         session_cookie_name_ = name;
     }
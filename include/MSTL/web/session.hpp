@@ -3,9 +3,10 @@
 #include "MSTL/core/random.hpp"
 #include "MSTL/core/unordered_map.hpp"
 #include "MSTL/core/stringstream.hpp"
-#include "MSTL/core/hexadecimal.hpp"
+#include "MSTL/core/memory.hpp"
 #include <mutex>
 #include <thread>
+#include <condition_variable>
 MSTL_BEGIN_NAMESPACE__
 
 struct cookie {
@@ -208,40 +209,107 @@ public:
 };
 
 
+// sessions are spread over independently locked shards by id hash.
+// expiry runs on a hashed timer wheel ticking once a second: each tick only
+// visits the sessions scheduled in its slot, and one still in use is moved to
+// the slot of its new deadline instead of being touched on every access.
 class __session_manager {
 private:
-    unordered_map<string, session> sessions_;
-    std::mutex mutex_;
-    std::atomic<bool> cleanup_running_{false};
+    static constexpr size_t SHARD_COUNT = 16;
+    static constexpr size_t WHEEL_SLOTS = 512;
+
+    struct __wheel_entry {
+        string id{};
+        uint64_t due = 0;
+    };
+
+    struct __session_shard {
+        std::mutex mutex;
+        unordered_map<string, shared_ptr<session>> sessions{};
+        vector<__wheel_entry> wheel[WHEEL_SLOTS];
+    };
+
+    __session_shard shards_[SHARD_COUNT];
+    std::atomic<uint64_t> tick_{0};
+    std::mutex cleanup_mutex_;
+    std::condition_variable cleanup_cv_;
+    bool cleanup_running_ = false;
     std::thread cleanup_thread_;
 
     friend class servlet;
 
+    // 128 bits from the calling thread's ChaCha generator, hex encoded.
     static string generate_session_id() {
-        ostringstream ss;
-        for (int i = 0; i < 32; ++i) {
-            ss << hexadecimal(random_mt::next_int(0, 15)).to_std_string();
+        static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+        byte_t bytes[16];
+        random_chacha::fill(bytes, sizeof(bytes));
+
+        string id(sizeof(bytes) * 2, '0');
+        char* out = id.data();
+        for (const byte_t b : bytes) {
+            *out++ = HEX_DIGITS[b >> 4];
+            *out++ = HEX_DIGITS[b & 0x0f];
+        }
+        return id;
+    }
+
+    __session_shard& shard_of(const string& session_id) noexcept {
+        return shards_[_MSTL hash<string>()(session_id) % SHARD_COUNT];
+    }
+
+    static int64_t remaining_seconds(const session& s, const datetime& now) {
+        return s.get_max_age() - (now - s.get_last_access());
+    }
+
+    // caller holds the shard lock.
+    void schedule(__session_shard& shard, const string& session_id, int64_t delay) {
+        if (delay < 1) delay = 1;
+        const uint64_t due = tick_.load(std::memory_order_relaxed) + static_cast<uint64_t>(delay);
+        shard.wheel[due % WHEEL_SLOTS].push_back({session_id, due});
+    }
+
+    void expire_slot(__session_shard& shard, const uint64_t tick, vector<shared_ptr<session>>& expired) {
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        vector<__wheel_entry>& slot = shard.wheel[tick % WHEEL_SLOTS];
+        if (slot.empty()) return;
+
+        vector<__wheel_entry> pending;
+        pending.swap(slot);
+        const datetime now = datetime::now();
+        for (auto& entry : pending) {
+            if (entry.due > tick) {
+                slot.push_back(_MSTL move(entry));  // due in a later round
+                continue;
+            }
+            auto it = shard.sessions.find(entry.id);
+            if (it == shard.sessions.end()) continue;  // removed meanwhile
+
+            const int64_t remaining = remaining_seconds(*it->second, now);
+            if (it->second->is_valid() && remaining > 0) {
+                schedule(shard, entry.id, remaining);
+            } else {
+                expired.push_back(_MSTL move(it->second));
+                shard.sessions.erase(it);
+            }
         }
-        return ss.str();
     }
 
     void cleanup_expired_sessions() {
+        vector<shared_ptr<session>> expired;
+        std::unique_lock<std::mutex> lock(cleanup_mutex_);
         while (cleanup_running_) {
-            {
-                std::lock_guard<std::mutex> lock(mutex_);
-                datetime now = datetime::now();
-                auto it = sessions_.begin();
-                while (it != sessions_.end()) {
-                    const int64_t diff = now - it->second.get_last_access();
-                    if (!it->second.is_valid() ||
-                        diff > it->second.get_max_age()) {
-                        it = sessions_.erase(it);
-                    } else {
-                        ++it;
-                    }
-                }
+            cleanup_cv_.wait_for(lock, std::chrono::seconds(1));
+            if (!cleanup_running_) break;
+            lock.unlock();
+
+            const uint64_t tick = tick_.fetch_add(1, std::memory_order_relaxed) + 1;
+            for (auto& shard : shards_) {
+                expire_slot(shard, tick, expired);
             }
-            std::this_thread::sleep_for(std::chrono::minutes(5));
+            // sessions still referenced by a running request die with that request
+            expired.clear();
+
+            lock.lock();
         }
     }
 
@@ -251,45 +319,71 @@ private:
     }
 
     ~__session_manager() {
-        cleanup_running_ = false;
+        {
+            std::lock_guard<std::mutex> lock(cleanup_mutex_);
+            cleanup_running_ = false;
+        }
+        cleanup_cv_.notify_all();
         if (cleanup_thread_.joinable()) {
             cleanup_thread_.join();
         }
     }
 
-    session* get_session(const string& session_id, bool create = true) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = sessions_.find(session_id);
-        if (it != sessions_.end()) {
-            if (it->second.is_valid()) {
-                it->second.set_new(false);
-                return &it->second;
-            }
-            sessions_.erase(it);
+    // one locked lookup, the session found is touched and no longer new.
+    shared_ptr<session> find_session(const string& session_id) {
+        if (session_id.empty()) return nullptr;
+        __session_shard& shard = shard_of(session_id);
+        shared_ptr<session> stale;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(session_id);
+        if (it == shard.sessions.end()) return nullptr;
+        if (!it->second->is_valid()) {
+            stale = _MSTL move(it->second);
+            shard.sessions.erase(it);
+            return nullptr;
         }
-
-        if (create) {
-            string new_id = session_id.empty() ? generate_session_id() : session_id;
-            const auto pir = sessions_.emplace(new_id, session(new_id));
-            return &pir.first->second;
+        it->second->set_last_access(datetime::now());
+        it->second->set_new(false);
+        return it->second;
+    }
+
+    shared_ptr<session> create_session() {
+        while (true) {
+            string new_id = generate_session_id();
+            __session_shard& shard = shard_of(new_id);
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            if (shard.sessions.find(new_id) != shard.sessions.end()) continue;
+
+            auto created = _MSTL make_shared<session>(new_id);
+            schedule(shard, new_id, created->get_max_age());
+            shard.sessions[new_id] = created;
+            return created;
         }
-
-        return nullptr;
     }
 
-    session* create_session() {
-        return get_session("", true);
+    shared_ptr<session> get_session(const string& session_id, const bool create = true) {
+        shared_ptr<session> found = find_session(session_id);
+        if (found || !create) return found;
+        return create_session();
     }
 
     void remove_session(const string& session_id) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        sessions_.erase(session_id);
-    }
-
-    bool session_exists(const string& session_id) {
-        std::lock_guard<std::mutex> lock(mutex_);
-        auto it = sessions_.find(session_id);
-        return it != sessions_.end() && it->second.is_valid();
+        __session_shard& shard = shard_of(session_id);
+        shared_ptr<session> removed;
+        std::lock_guard<std::mutex> lock(shard.mutex);
+        auto it = shard.sessions.find(session_id);
+        if (it == shard.sessions.end()) return;
+        removed = _MSTL move(it->second);
+        shard.sessions.erase(it);
+    }
+
+    MSTL_NODISCARD size_t size() {
+        size_t total = 0;
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> lock(shard.mutex);
+            total += shard.sessions.size();
+        }
+        return total;
     }
 };
 
@@ -344,6 +438,8 @@ enum class HTTP_STATUS : uint16_t {
     S4_PAYLOAD_LARGE = 413,
     // The URL of the request is too long
     S4_URL_LONG = 414,
+    // The requested range lies outside the resource
+    S4_RANGE_NOT_SATISFIABLE = 416,
     // Excessive number of requests
     S4_MANY_REQUESTS = 429,
 
@@ -434,6 +530,9 @@ public:
     string to_string() const {
         return method_;
     }
+    const string& name() const noexcept {
+        return method_;
+    }
 };
 
 template <>
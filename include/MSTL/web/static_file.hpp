@@ -0,0 +1,201 @@
+#ifndef MSTL_STATIC_FILE_HPP__
+#define MSTL_STATIC_FILE_HPP__
+#include "http_writer.hpp"
+#include "MSTL/core/list.hpp"
+#include "MSTL/core/unordered_map.hpp"
+#include <mutex>
+#include <ctime>
+#include <cstdio>
+#include <sys/stat.h>
+MSTL_BEGIN_NAMESPACE__
+
+// IMF-fixdate as used by Last-Modified and If-Modified-Since, "Sun, 06 Nov 1994 08:49:37 GMT".
+inline string http_date_format(const ::time_t time) {
+    static constexpr const char* WEEKDAYS[] = {"Sun", "Mon", "Tue", "Wed", "Thu", "Fri", "Sat"};
+    static constexpr const char* MONTHS[] = {
+        "Jan", "Feb", "Mar", "Apr", "May", "Jun", "Jul", "Aug", "Sep", "Oct", "Nov", "Dec"
+    };
+    ::tm tm_gmt{};
+#ifdef MSTL_PLATFORM_WINDOWS__
+    ::gmtime_s(&tm_gmt, &time);
+#elif defined(MSTL_PLATFORM_LINUX__)
+    ::gmtime_r(&time, &tm_gmt);
+#endif
+    char buffer[32];
+    const int length = std::snprintf(buffer, sizeof(buffer), "%s, %02d %s %04d %02d:%02d:%02d GMT",
+        WEEKDAYS[tm_gmt.tm_wday], tm_gmt.tm_mday, MONTHS[tm_gmt.tm_mon], tm_gmt.tm_year + 1900,
+        tm_gmt.tm_hour, tm_gmt.tm_min, tm_gmt.tm_sec);
+    return string(buffer, length);
+}
+
+inline bool http_date_parse(const string_view text, ::time_t& time) {
+    static constexpr const char* MONTHS = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    if (text.size() != 29) return false;
+    const char* p = text.data();
+    const auto number = [p](const size_t pos, const size_t count, int& value) {
+        value = 0;
+        for (size_t i = pos; i < pos + count; ++i) {
+            if (!_MSTL is_digit(p[i])) return false;
+            value = value * 10 + (p[i] - '0');
+        }
+        return true;
+    };
+
+    int day, year, hour, minute, second;
+    if (p[3] != ',' || !number(5, 2, day) || !number(12, 4, year) || !number(17, 2, hour) ||
+        !number(20, 2, minute) || !number(23, 2, second)) return false;
+    int month = 0;
+    while (month < 12 && _MSTL memory_compare(MONTHS + month * 3, p + 8, 3) != 0) ++month;
+    if (month == 12) return false;
+
+    // days since epoch of a proleptic gregorian date
+    const int y = month < 2 ? year - 1 : year;
+    const int era = (y >= 0 ? y : y - 399) / 400;
+    const int yoe = y - era * 400;
+    const int mp = (month + 10) % 12;
+    const int doy = (153 * mp + 2) / 5 + day - 1;
+    const int doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    const int64_t days = static_cast<int64_t>(era) * 146097 + doe - 719468;
+    time = static_cast<::time_t>(days * 86400 + hour * 3600 + minute * 60 + second);
+    return true;
+}
+
+inline const char* http_mime_type(const string_view path) {
+    struct mime { const char* extension; const char* type; };
+    static constexpr mime MIMES[] = {
+        {"html", "text/html; charset=utf-8"}, {"htm", "text/html; charset=utf-8"},
+        {"css", "text/css; charset=utf-8"}, {"js", "text/javascript; charset=utf-8"},
+        {"json", "application/json"}, {"xml", "text/xml"}, {"txt", "text/plain; charset=utf-8"},
+        {"png", "image/png"}, {"jpg", "image/jpeg"}, {"jpeg", "image/jpeg"}, {"gif", "image/gif"},
+        {"bmp", "image/bmp"}, {"webp", "image/webp"}, {"svg", "image/svg+xml"}, {"ico", "image/x-icon"},
+        {"woff", "font/woff"}, {"woff2", "font/woff2"}, {"ttf", "font/ttf"},
+        {"wasm", "application/wasm"}, {"pdf", "application/pdf"}, {"mp4", "video/mp4"}
+    };
+    const size_t dot = path.rfind('.');
+    if (dot == string_view::npos) return "application/octet-stream";
+    const string_view extension = path.substr(dot + 1);
+    for (const auto& m : MIMES) {
+        if (extension.size() == _MSTL string_length(m.extension) &&
+            _MSTL memory_compare_ignore_case(extension.data(), m.extension, extension.size()) == 0) {
+            return m.type;
+        }
+    }
+    return "application/octet-stream";
+}
+
+
+// LRU of memory mapped files, keyed by path and revalidated by mtime and size.
+// files larger than the single file limit are described but not mapped,
+// they are meant to be sent with sendfile instead.
+class static_file_cache {
+public:
+    struct entry {
+        string path{};
+        size_t size = 0;
+        ::time_t mtime = 0;
+        string etag{};
+        string last_modified{};
+        shared_ptr<mapped_file> mapping{};  // null for files above the mapping limit
+    };
+
+private:
+    using entry_list = list<shared_ptr<entry>>;
+
+    entry_list lru_{};
+    unordered_map<string, entry_list::iterator> index_{};
+    size_t capacity_;
+    size_t max_file_size_;
+    size_t mapped_size_ = 0;
+    std::mutex mtx_;
+
+    static bool stat_file(const string& path, size_t& size, ::time_t& mtime) {
+#ifdef MSTL_PLATFORM_WINDOWS__
+        struct ::_stat64 info{};
+        if (::_stat64(path.c_str(), &info) != 0 || !(info.st_mode & _S_IFREG)) return false;
+#elif defined(MSTL_PLATFORM_LINUX__)
+        struct ::stat info{};
+        if (::stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) return false;
+#endif
+        size = static_cast<size_t>(info.st_size);
+        mtime = info.st_mtime;
+        return true;
+    }
+
+    void evict() {
+        while (mapped_size_ > capacity_ && !lru_.empty()) {
+            const shared_ptr<entry>& victim = lru_.back();
+            mapped_size_ -= victim->size;
+            index_.erase(victim->path);
+            lru_.pop_back();
+        }
+    }
+
+public:
+    explicit static_file_cache(const size_t capacity = 64 * 1024 * 1024,
+        const size_t max_file_size = 1024 * 1024)
+        : capacity_(capacity), max_file_size_(max_file_size) {}
+
+    static_file_cache(const static_file_cache&) = delete;
+    static_file_cache& operator =(const static_file_cache&) = delete;
+
+    // null when path is not a readable regular file.
+    shared_ptr<entry> lookup(const string& path) {
+        size_t size;
+        ::time_t mtime;
+        if (!stat_file(path, size, mtime)) return nullptr;
+
+        {
+            std::lock_guard<std::mutex> lock(mtx_);
+            auto it = index_.find(path);
+            if (it != index_.end()) {
+                const shared_ptr<entry>& cached = *it->second;
+                if (cached->mtime == mtime && cached->size == size) {
+                    lru_.splice(lru_.begin(), lru_, it->second);
+                    return cached;
+                }
+                mapped_size_ -= cached->size;
+                lru_.erase(it->second);
+                index_.erase(it);
+            }
+        }
+
+        auto result = _MSTL make_shared<entry>();
+        result->path = path;
+        result->size = size;
+        result->mtime = mtime;
+        result->etag = "\"" + _MSTL to_string(static_cast<uint64_t>(size)) + "-" +
+            _MSTL to_string(static_cast<int64_t>(mtime)) + "\"";
+        result->last_modified = http_date_format(mtime);
+        if (size > max_file_size_) return result;
+
+        // mapping happens outside the lock, a racing thread may map the same file once more
+        const file source(path, FILE_ACCESS::READ);
+        auto mapping = _MSTL make_shared<mapped_file>();
+        if (!mapping->map(source)) return nullptr;
+        result->mapping = _MSTL move(mapping);
+
+        std::lock_guard<std::mutex> lock(mtx_);
+        if (index_.find(path) == index_.end()) {
+            lru_.push_front(result);
+            index_[path] = lru_.begin();
+            mapped_size_ += size;
+            evict();
+        }
+        return result;
+    }
+
+    void clear() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        index_.clear();
+        lru_.clear();
+        mapped_size_ = 0;
+    }
+
+    MSTL_NODISCARD size_t mapped_size() {
+        std::lock_guard<std::mutex> lock(mtx_);
+        return mapped_size_;
+    }
+};
+
+MSTL_END_NAMESPACE__
+#endif // MSTL_STATIC_FILE_HPP__
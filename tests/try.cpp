@@ -420,6 +420,14 @@ void test_exce() {
     }
 }
 
+struct json_student {
+    string name;
+    int age = 0;
+    vector<double> grades;
+    optional<string> nickname;
+};
+MSTL_JSON_FIELDS(json_student, name, age, grades, nickname)
+
 void test_json() {
     string json_str = R"(
     {
@@ -431,7 +439,8 @@ void test_json() {
             "street": "123 Main St",
             "city": "Anytown"
         },
-        "hobbies": ["reading", "gaming", null]
+        "hobbies": ["reading", "gaming", null],
+        "motto": "strings longer than a scan step, with \"escapes\"\tinside"
     }
     )";
 
@@ -449,6 +458,10 @@ void test_json() {
             if (ageVal && ageVal->is_number()) {
                 println("Age: ", ageVal->as_number()->get_value());
             }
+            const json_value* mottoVal = obj->get_member("motto");
+            if (mottoVal && mottoVal->is_string()) {
+                println("Motto: ", mottoVal->as_string()->get_value());
+            }
             const json_value* gradesVal = obj->get_member("grades");
             if (gradesVal && gradesVal->is_array()) {
                 const json_array* grades = gradesVal->as_array();
@@ -491,6 +504,42 @@ void test_json() {
         string result3 = json_to_string(json3);
         println(result3);
 
+        const json_document doc = json_document::parse(string_view(json_str.data(), json_str.size()));
+        const json_view view = doc.root();
+        println("Name: ", view["name"].as_string(), ", nodes: ", doc.node_count());
+        for (const json_member member : view["address"].members()) {
+            println(member.key, ": ", member.value.as_string());
+        }
+        for (const json_view grade : view["grades"].elements()) {
+            print(grade.as_number(), " ");
+        }
+        println();
+
+        string text;
+        json_writer writer(text, 2);
+        writer.begin_object().key("grades").write(view["grades"]).key("ratio").value(0.1).key("id").value(12345678901LL).end_object();
+        println(text);
+
+        struct level_counter : json_handler {
+            size_t errors = 0;
+            bool level = false;
+            void key(const string_view k) override { level = k == string_view("level"); }
+            void string_value(const string_view v) override { errors += level && v == string_view("error"); }
+        } counter;
+        const string ndjson = "{\"level\":\"info\"}\n{\"level\":\"error\"}\n{\"level\":\"error\"}\n";
+        json_reader reader(true);
+        for (size_t i = 0; i < ndjson.size(); i += 7) {
+            reader.feed(ndjson.data() + i, _MSTL min(size_t(7), ndjson.size() - i));
+            reader.parse(counter);
+        }
+        reader.finish();
+        reader.parse(counter);
+        println("documents: ", reader.documents(), ", errors: ", counter.errors);
+
+        const auto student = json_deserialize<json_student>(json_str);
+        println(student.name, " ", student.age, " ", student.grades.size(), " ", student.nickname.has_value());
+        println(json_serialize(json_deserialize<json_student>(json_serialize(student))));
+
     } catch (const Error& e) {
         println(e);
     }
@@ -499,6 +548,8 @@ void test_json() {
 void test_serv() {
     try {
         example_servlet server(8080);
+        server.set_mode(SERVLET_MODE::MODE_REACTOR);
+        server.set_keep_alive_timeout(10);
         server.start();
         getchar();
         server.stop();
@@ -507,6 +558,21 @@ void test_serv() {
     }
 }
 
+void test_http_parser() {
+    const char request[] = "POST /upload HTTP/1.1\r\nContent-Length: 99999999999\r\n\r\n";
+    for (size_t limit = 0; limit <= 8; ++limit) {
+        http_parser parser(1024 * 16, limit);
+        println(limit, parser.parse(request, sizeof(request) - 1) == HTTP_PARSE_STATUS::BODY_TOO_LARGE);
+    }
+
+    const char small[] = "POST /upload HTTP/1.1\r\nContent-Length: 5\r\n\r\nhello";
+    http_parser fits(1024 * 16, 5);
+    println(fits.parse(small, sizeof(small) - 1) == HTTP_PARSE_STATUS::COMPLETE);
+    println(fits.content_length());
+    http_parser over(1024 * 16, 4);
+    println(over.parse(small, sizeof(small) - 1) == HTTP_PARSE_STATUS::BODY_TOO_LARGE);
+}
+
 void test_list() {
     list<int> lls{ 1,2,3,4,5,6,7 };
     println(lls);
@@ -1254,13 +1320,24 @@ void test_timer(){
         }
         while (t.check()) {}
     }
+
+    std::atomic<int> fired{0};
+    t.start();
+    for (int i = 0; i < 100; ++i) {
+        t.add(i % 10, [&fired](const timer_node&) { ++fired; });
+    }
+    auto cancelled = t.add(5, [&fired](const timer_node&) { fired += 100; });
+    t.erase(cancelled);
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    t.stop();
+    println("驱动线程触发定时器数: ", fired.load(), "，剩余: ", t.size());
 }
 
 
 void test_dbpool() {
 #ifdef MSTL_SUPPORT_DB__
-#ifdef MSTL_SUPPORT_MYSQL__
     std::clock_t begin = clock();
+#ifdef MSTL_SUPPORT_MYSQL__
     db_connect_config mysql_config = db_connect_config::for_mysql("book");
     mysql_config.password = "147258hu";
 
@@ -1324,6 +1401,46 @@ void test_dbpool() {
         delete conn;
     }
     println(1.0 * (clock() - begin) / CLOCKS_PER_SEC);
+
+    {
+        database_pool pool(DB_TYPE::SQLITE3, sqlite_config, 4, 16);
+        begin = clock();
+        for (int i = 0; i < 5000; i++) {
+            bool fin = pool.get_connect()->update("SELECT 1");
+        }
+        println(1.0 * (clock() - begin) / CLOCKS_PER_SEC, ", pool size: ", pool.size());
+
+        auto conn = pool.get_connect();
+        begin = clock();
+        for (int i = 0; i < 5000; i++) {
+            auto statement = conn->prepare("SELECT ?");
+            bool fin = statement->bind(0, i) && statement->execute();
+        }
+        println(1.0 * (clock() - begin) / CLOCKS_PER_SEC, ", cached statements: ", conn->cached_statements());
+
+        auto result = conn->query_stream("WITH RECURSIVE n(x) AS (SELECT 1 UNION ALL SELECT x + 1 FROM n WHERE x < 100000) SELECT x FROM n");
+        int64_t sum = 0;
+        begin = clock();
+        for (db_row_view row : result->rows()) {
+            sum += row[0].as_int64();
+        }
+        println(1.0 * (clock() - begin) / CLOCKS_PER_SEC, ", streamed sum: ", sum);
+        result = nullptr;
+        conn = nullptr;
+
+        thread_pool& executor = get_instance_thread_pool();
+        executor.start();
+        pool.set_max_in_flight(4);
+        vector<std::future<bool>> futures;
+        begin = clock();
+        for (int i = 0; i < 5000; i++) {
+            futures.push_back(pool.async_update("SELECT 1"));
+        }
+        size_t done = 0;
+        for (auto& future : futures) done += future.get();
+        println(1.0 * (clock() - begin) / CLOCKS_PER_SEC, ", async updates: ", done);
+        executor.stop();
+    }
 #endif
 #endif
 }
@@ -1359,4 +1476,80 @@ void test_tpool() {
     pool.submit_task(test_file);
     // pool.submit_task(try_db);
     pool.stop();
+    pool.set_mode(THREAD_POOL_MODE::MODE_STEALING);
+    pool.start(4);
+    std::atomic<int> finished{0};
+    for (int i = 0; i < 64; ++i) {
+        pool.submit_task([&pool, &finished] {
+            for (int j = 0; j < 64; ++j) {
+                pool.post([&finished] { ++finished; });
+            }
+        });
+    }
+    pool.stop();
+    println(finished.load() == 64 * 64);
+
+    pool.set_mode(THREAD_POOL_MODE::MODE_FIXED);
+    pool.set_full_policy(FULL_POLICY::REJECT);
+    pool.start(1);
+    auto urgent = pool.submit_task(TASK_PRIORITY::HIGH, [] { return 1; });
+    auto late = pool.submit_task(task_option::within(std::chrono::milliseconds(0)), [] { return 2; });
+    println(urgent.get());
+    try {
+        println(late.get());
+    } catch (const TaskExpiredError& error) {
+        println(error.what());
+    }
+    pool.stop();
+    pool.set_full_policy(FULL_POLICY::BLOCK);
+}
+
+void test_ring_buffer() {
+    mpmc_ring_buffer<int> ring(1000);
+    println(ring.capacity());
+    std::atomic<int> total{0};
+    std::thread consumer([&ring, &total] {
+        int values[32];
+        int received = 0;
+        while (received < 4 * 10000) {
+            const size_t count = ring.pop_n(values, 32);
+            for (size_t i = 0; i < count; ++i) total += values[i];
+            received += static_cast<int>(count);
+        }
+    });
+    vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&ring] {
+            for (int i = 1; i <= 10000; ++i) {
+                while (!ring.try_push(i)) std::this_thread::yield();
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    consumer.join();
+    println(total.load() == 4 * 10000 * 10001 / 2);
+
+    spsc_ring_buffer<string> pipe(2);
+    pipe.try_push("first");
+    pipe.try_emplace("second");
+    println(pipe.try_push("third"));
+    string out;
+    while (pipe.try_pop(out)) println(out);
+}
+
+void test_lock_free_queue() {
+    lock_free_queue<string> queue;
+    println(queue.empty(), queue.pop() == nullptr);
+    vector<std::thread> producers;
+    for (int p = 0; p < 4; ++p) {
+        producers.emplace_back([&queue, p] {
+            for (int i = 0; i < 1000; ++i) queue.push(to_string(p));
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    int popped = 0;
+    string value;
+    while (queue.try_pop(value)) ++popped;
+    println(popped == 4000, queue.empty());
+    hazard_reclaim();
 }
@@ -16,6 +16,33 @@ public:
         auto log_filt = new logging_filter();
         add_filter(cors_filt);
         add_filter(log_filt);
+        add_static("/", "../resource");
+
+        for (const HTTP_METHOD& method : {HTTP_METHOD::GET, HTTP_METHOD::POST}) {
+            add_route(method, "/api/session", [this](http_request& request, http_response& response) {
+                handle_session_api(request, response);
+            });
+            add_route(method, "/api/session-attribute", [this](http_request& request, http_response& response) {
+                handle_session_attribute(request, response);
+            });
+            add_route(method, "/api/cookie", [this](http_request& request, http_response& response) {
+                handle_cookie_api(request, response);
+            });
+            add_route(method, "/api/logger-test", [](http_request& request, http_response& response) {
+                response.set_ok();
+                response.set_body("Logging filter test successful");
+            });
+            add_route(method, "/api/data", [](http_request& request, http_response& response) {
+                response.set_ok();
+                response.set_content_type(HTTP_CONTENT::JSON_APP);
+                response.set_body(R"({"status":"success"})");
+            });
+            add_route(method, "/api/data/:key", [](http_request& request, http_response& response) {
+                response.set_ok();
+                response.set_content_type(HTTP_CONTENT::JSON_APP);
+                response.set_body(R"({"key":")" + request.get_path_variable("key") + R"("})");
+            });
+        }
     }
 
     void do_get(http_request& request, http_response& response) override {
@@ -38,42 +65,6 @@ public:
             return;
         }
 
-        if (path.ends_with(".css") || path.ends_with(".jpg")) {
-            response.set_ok();
-            if (path.ends_with(".css")) {
-                response.set_content_type(HTTP_CONTENT::CSS_TEXT);
-                response.set_body(_MSTL move(file::read("../resource" + path)));
-            } else if (path.ends_with(".jpg")) {
-                response.set_content_type(HTTP_CONTENT::JPEG_IMG);
-                response.set_body(_MSTL move(file::read_binary("../resource" + path)));
-            }
-            return;
-        }
-
-        if (path == "/api/session") {
-            handle_session_api(request, response);
-            return;
-        }
-        if (path == "/api/session-attribute") {
-            handle_session_attribute(request, response);
-            return;
-        }
-        if (path == "/api/cookie") {
-            handle_cookie_api(request, response);
-            return;
-        }
-        if (path == "/api/logger-test") {
-            response.set_ok();
-            response.set_body("Logging filter test successful");
-            return;
-        }
-        if (path == "/api/data") {
-            response.set_ok();
-            response.set_content_type(HTTP_CONTENT::JSON_APP);
-            response.set_body(R"({"status":"success"})");
-            return;
-        }
-
         if (path == "/") {
             response.set_ok();
             response.set_status_msg("OK");
@@ -257,6 +248,7 @@ private:
 };
 
 void test_serv();
+void test_http_parser();
 
 void test_list();
 void test_exce();
@@ -305,6 +297,8 @@ void test_any();
 void test_timer();
 void test_dbpool();
 void test_tpool();
+void test_ring_buffer();
+void test_lock_free_queue();
 void test_dns();
 
 #endif //TRY_H